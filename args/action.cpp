@@ -1,8 +1,22 @@
 #include "action.h"
 #include "../data/maze.h"
+#include "../data/parallel.h"
+#include "../data/row_sink.h"
+#include "../generators/binary_tree_generator.h"
+#include "../generators/eller_generator.h"
 #include "../generators/recursivegen_stack.h"
-#include "../generators/recursive_generator.h"
-#include "../generators/prim_generator.h"
+#include "../generators/recursivegen_walls.h"
+#include "../generators/grow_tree_generator.h"
+#include "../generators/kruskal_generator.h"
+#include "../generators/procedural_generator.h"
+#include "../generators/sidewinder_generator.h"
+#include "../generators/tiled_generator.h"
+#include "../generators/wilson_generator.h"
+#include "../solvers/astar_solver.h"
+#include "../solvers/bfs_solver.h"
+#include "../solvers/bidirectional_solver.h"
+#include "../solvers/dead_end_solver.h"
+#include "../solvers/parallel_bfs_solver.h"
 
 
 /**
@@ -11,6 +25,72 @@
  * command line.
  **/
 
+namespace {
+/**
+ * a stream buffer that throws away everything written to it
+ **/
+class discard_buffer : public std::streambuf {
+ protected:
+  virtual int overflow(int c) { return traits_type::not_eof(c); }
+};
+
+/**
+ * points a stream at another buffer for as long as it is in scope
+ **/
+class redirect {
+  std::ostream& _stream;
+  std::streambuf* _old;
+
+ public:
+  redirect(std::ostream& stream, std::streambuf* buffer)
+      : _stream(stream), _old(stream.rdbuf(buffer)) {}
+  ~redirect(void) { _stream.rdbuf(_old); }
+};
+
+/**
+ * marks the passages along a path, given as the cells along it, as the
+ * solution of a maze. They are marked from the finish back, the same as
+ * the depth first search does.
+ **/
+void mark_path(mazer2018::data::maze& m,
+               const std::vector<mazer2018::data::cell_id>& path) {
+  for (std::size_t i = path.size(); i > 1; --i) {
+    m.mark_solution(mazer2018::data::edge(m.x_of(path[i - 2]),
+                                          m.y_of(path[i - 2]),
+                                          m.x_of(path[i - 1]),
+                                          m.y_of(path[i - 1])));
+  }
+}
+
+/**
+ * generates a maze with the growing tree policy specified, from a single
+ * frontier unless tiled is set. A tiled maze bigger than one tile is cut
+ * into tiles that are generated in parallel when more than one thread is
+ * asked for, and on a single thread otherwise, so the maze doesn't depend
+ * on the number of threads.
+ **/
+template <class Policy>
+void grow_maze(mazer2018::data::maze& m, int seed, int width, int height,
+               unsigned threads, bool tiled, Policy policy) {
+  using namespace mazer2018;
+  // the tiles of a masked maze can't be joined along arbitrary borders
+  if (!tiled || m.masked() ||
+      generators::tiled_generator::single_tile(width, height)) {
+    generators::grow_tree_generator<Policy> generator(m, seed, width, height,
+                                                      policy);
+    generator.generate();
+    return;
+  }
+  generators::tiled_generator generator(
+      m, width, height, seed, threads, [policy](data::maze& tile, int seed) {
+        generators::grow_tree_generator<Policy> generator(
+            tile, seed, tile.width(), tile.height(), policy);
+        generator.grow();
+      });
+  generator.generate();
+}
+}  // namespace
+
 /**
  * @param m the maze data structure to initialise and write the generated
  * maze to.
@@ -18,27 +98,230 @@
 mazer2018::data::maze& mazer2018::args::generate_action::do_action(
     mazer2018::data::maze& m) {
 
-	// recursive
-	if (_gen_type == 0) {
-		generators::recursive_generator generator(m, _seed, _width, _height);
+	if (streams_rows(_type) && m.masked()) {
+		throw action_failed(
+		    "A maze generated a row at a time can't be cut out of a mask.");
+	}
+	if ((_type == generator_type::DIVISION ||
+	     _type == generator_type::DIVISION_WALLS ||
+	     _type == generator_type::PROCEDURAL) &&
+	    m.masked()) {
+		throw action_failed(
+		    "Recursive division can't generate a maze cut out of a mask.");
+	}
+	// a maze cut out of a mask is always the size of the mask
+	unsigned width = _width, height = _height;
+	unsigned threads = _threads;
+	if (m.masked()) {
+		width = m.width();
+		height = m.height();
+		// neither the mask nor the sparse grid of a masked maze is safe to
+		// share between threads
+		if (threads != 1) {
+			std::cout << "A masked maze is generated on a single thread."
+			          << std::endl;
+			threads = 1;
+		}
+	}
+	if (_type == generator_type::PROCEDURAL) {
+		// nothing is generated until it is read, so there is nothing to
+		// spread over threads
+		generators::procedural_generator generator(m, int(width), int(height),
+		                                           _seed, std::size_t(_param));
 		generator.generate();
+		return m;
 	}
-	else if (_gen_type == 1) {
-		generators::prim_generator generator(m, _seed, _width, _height);
+	if (_type == generator_type::KRUSKAL) {
+		generators::kruskal_generator generator(m, width, height, _seed, threads);
 		generator.generate();
+		m.sync();
+		return m;
 	}
+	if (streams_rows(_type)) {
+		if (threads != 1) {
+			std::cout << "A maze generated a row at a time is generated on a "
+			          << "single thread." << std::endl;
+		}
+		// the maze only goes into memory when there is no file to stream
+		// it into
+		std::vector<std::unique_ptr<data::row_sink>> sinks;
+		for (const auto& stream : _streams) {
+			if (stream.first == save_type::BINARY) {
+				sinks.push_back(std::make_unique<data::binary_row_sink>(stream.second));
+			} else {
+				sinks.push_back(std::make_unique<data::svg_row_sink>(stream.second));
+			}
+		}
+		if (sinks.empty()) {
+			sinks.push_back(std::make_unique<data::maze_row_sink>(m));
+		}
+		std::vector<data::row_sink*> targets;
+		for (auto& sink : sinks) {
+			targets.push_back(sink.get());
+		}
+		bool streamed = false;
+		if (_type == generator_type::ELLER) {
+			generators::eller_generator generator(int(width), int(height), _seed);
+			streamed = generator.generate(targets);
+		} else if (_type == generator_type::BINARY_TREE) {
+			generators::binary_tree_generator generator(int(width), int(height),
+			                                            _seed);
+			streamed = generator.generate(targets);
+		} else {
+			generators::sidewinder_generator generator(int(width), int(height),
+			                                           _seed);
+			streamed = generator.generate(targets);
+		}
+		if (!streamed) {
+			throw action_failed("There was an error streaming the maze.");
+		}
+		return m;
+	}
+	if (_type == generator_type::WILSON) {
+		// tiles joined along their borders would no longer be a uniform
+		// spanning tree
+		if (threads != 1) {
+			std::cout << "Wilson's algorithm runs on a single thread."
+			          << std::endl;
+		}
+		generators::wilson_generator generator(m, width, height, _seed);
+		generator.generate();
+		m.sync();
+		return m;
+	}
+	if (_type == generator_type::DIVISION) {
+		if (stack) {
+			if (threads != 1) {
+				std::cout << "The stack based recursive division runs on a "
+				          << "single thread." << std::endl;
+			}
+			generators::recursivegen_stack generator(m, width, height, _seed);
+			generator.generate();
+		} else {
+			generators::recursivegen generator(m, width, height, _seed, threads,
+			                                   std::size_t(_param));
+			generator.generate();
+		}
+		m.sync();
+		return m;
+	}
+	if (_type == generator_type::DIVISION_WALLS) {
+		if (threads != 1) {
+			std::cout << "Recursive division by walls runs on a single thread."
+			          << std::endl;
+		}
+		generators::recursivegen_walls generator(m, width, height, _seed);
+		generator.generate();
+		m.sync();
+		return m;
+	}
+	if (threads != 1 && !_tiled) {
+		std::cout << "A growing tree maze runs on a single thread unless it "
+		          << "is --tiled." << std::endl;
+	}
+	// each policy is its own instantiation of the generator so the choice
+	// is made once here rather than on every step
+	switch (_growth) {
+	case growth_type::NEWEST:
+		grow_maze(m, _seed, width, height, threads, _tiled, generators::newest_policy());
+		break;
+	case growth_type::RANDOM:
+		grow_maze(m, _seed, width, height, threads, _tiled, generators::random_policy());
+		break;
+	case growth_type::OLDEST:
+		grow_maze(m, _seed, width, height, threads, _tiled, generators::oldest_policy());
+		break;
+	case growth_type::MIXED:
+		grow_maze(m, _seed, width, height, threads, _tiled,
+		          generators::mixed_policy(unsigned(_param)));
+		break;
+	case growth_type::WINDOW:
+		grow_maze(m, _seed, width, height, threads, _tiled,
+		          generators::window_policy(std::size_t(_param)));
+		break;
+	}
+	// a maze generated into a file is complete once its header is written
+	m.sync();
 	return m;
-	
+}
 
-  // create the generator
-  if (stack) {
-    generators::recursivegen_stack generator(m, _width, _height, _seed);
-    generator.generate();
-  } else {
-    generators::recursivegen generator(m, _width, _height, _seed);
-    // generate the maze
-    generator.generate();
+const std::string mazer2018::args::batch_action::SEED_FIELD = "{seed}";
+
+/**
+ * @param pattern the name given for the files of the batch
+ * @param seed the seed of the maze to save
+ **/
+std::string mazer2018::args::batch_action::file_name(
+    const std::string& pattern, int seed) {
+  std::string name = pattern;
+  const std::string value = std::to_string(seed);
+  for (std::string::size_type at = name.find(SEED_FIELD);
+       at != std::string::npos;
+       at = name.find(SEED_FIELD, at + value.size())) {
+    name.replace(at, SEED_FIELD.size(), value);
   }
+  return name;
+}
+
+/**
+ * @param type the kind of file to save
+ * @param name the name of the files to save, holding @ref SEED_FIELD
+ **/
+void mazer2018::args::batch_action::save_to(save_type type,
+                                            const std::string& name) {
+  if (name.find(SEED_FIELD) == std::string::npos) {
+    std::ostringstream oss;
+    oss << "Error: the file names of a batch must hold " << SEED_FIELD
+        << " so that every maze is saved to its own file." << std::endl;
+    throw action_failed(oss.str());
+  }
+  _saves.emplace_back(type, name);
+}
+
+/**
+ * the maze passed in is left alone - each maze of the batch is generated
+ * into a maze belonging to the thread that generates it. Everything the
+ * generators print for each maze is thrown away and the batch as a whole
+ * is reported instead.
+ **/
+mazer2018::data::maze& mazer2018::args::batch_action::do_action(
+    mazer2018::data::maze& m) {
+  if (m.masked()) {
+    throw action_failed("A batch of mazes can't be cut out of a mask.");
+  }
+  auto start_time = std::chrono::system_clock::now();
+  const std::size_t count = std::size_t(std::int64_t(_to) - _from + 1);
+  const unsigned threads = unsigned(
+      std::min<std::size_t>(data::thread_count(_generate.threads()), count));
+  std::vector<data::maze> mazes(threads);
+  for (data::maze& worker : mazes) {
+    worker.layout(m.layout());
+  }
+  {
+    discard_buffer discard;
+    redirect quiet(std::cout, &discard);
+    data::parallel_for(threads, count, [&](std::size_t i, unsigned worker) {
+      const int seed = int(std::int64_t(_from) + std::int64_t(i));
+      data::maze& maze = mazes[worker];
+      _generate.with_seed(seed).do_action(maze);
+      for (const auto& save : _saves) {
+        const std::string name = file_name(save.second, seed);
+        const bool saved = save.first == save_type::BINARY
+                               ? maze.save_binary(name)
+                               : maze.save_svg(name);
+        if (!saved) {
+          std::ostringstream oss;
+          oss << "There was an error saving the file " << name << std::endl;
+          throw action_failed(oss.str());
+        }
+      }
+    });
+  }
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generated " << count << " mazes on " << threads
+            << " threads" << std::endl;
+  std::cout << "batch cost time:" << total_time.count() << std::endl;
   return m;
 }
 
@@ -49,82 +332,132 @@ mazer2018::data::maze& mazer2018::args::path_finding_action::do_action(
 	mazer2018::data::maze& m) {
 	std::cout << "start maze path finding" << std::endl;
 
+	// the cells to find a path between are checked before the clock starts
+	data::cell_id start_cell = endpoint(m, _start_x, _start_y, m.first_cell());
+	data::cell_id finish_cell = endpoint(m, _goal_x, _goal_y, m.last_cell());
+
 	auto start_time = std::chrono::system_clock::now();
 
-	std::vector<std::vector<data::cell>> &cells = m.get_cells();
-	for (int y = 0; y < m.height(); y++) {
-		for (int x = 0; x < m.width(); x++) {
-			cells[y][x].is_visited = false;
+	// everything the search allocates comes from here and is freed in one
+	// go when the search is done
+	data::arena scratch;
+	bool find_res = false;
+	std::size_t explored = 0;
+	if (_solver == solver_type::DFS) {
+		data::traversal_context context(scratch);
+		find_res = is_finish_cell(m, context, start_cell, finish_cell, explored);
+		if (find_res) {
+			// walk back from the finish along the parent directions, marking
+			// the solution as we go
+			data::cell_id cur_cell = finish_cell;
+			while (cur_cell != start_cell) {
+				data::cell_id prev = m.neighbour(cur_cell, context.parent(cur_cell));
+				m.mark_solution(data::edge(m.x_of(prev), m.y_of(prev), m.x_of(cur_cell), m.y_of(cur_cell)));
+				cur_cell = prev;
+			}
 		}
-	}
-
-	data::cell &start_cell = m.get_cells()[0][0];
-	data::cell &finish_cell = m.get_cells()[m.height() - 1][m.width() - 1];
-
-	bool find_res = is_finish_cell(m, &start_cell, &finish_cell);
-	if (!find_res) {
-		std::cout << "Can not find maze path!" << std::endl;
-
-		data::cell *cell = &(m.get_cells()[m.height() - 1][m.width() - 1]);
-		while (true) {
-			if (cell->prev == nullptr) {
-				break;
+	} else {
+		// the other solvers give the path as the cells along it
+		std::vector<data::cell_id> path;
+		switch (_solver) {
+		case solver_type::BFS: {
+			solvers::bfs_solver solver(m, scratch);
+			find_res = solver.solve(start_cell, finish_cell, path);
+			explored = solver.explored();
+		} break;
+		case solver_type::ASTAR: {
+			solvers::astar_solver solver(m, scratch);
+			find_res = solver.solve(start_cell, finish_cell, path);
+			explored = solver.explored();
+		} break;
+		case solver_type::BIDIRECTIONAL: {
+			solvers::bidirectional_solver solver(m, scratch);
+			find_res = solver.solve(start_cell, finish_cell, path);
+			explored = solver.explored();
+		} break;
+		case solver_type::PARALLEL_BFS: {
+			solvers::parallel_bfs_solver solver(m, scratch, _threads);
+			if (solver.threads() != data::thread_count(_threads)) {
+				std::cout << "A sparse, masked or procedural maze is searched "
+				          << "on a single thread." << std::endl;
 			}
-			if (cell->prev->x == 0 && cell->prev->y == 0) {
-				break;
+			find_res = solver.solve(start_cell, finish_cell, path);
+			explored = solver.explored();
+		} break;
+		case solver_type::DEAD_END_FILL: {
+			if (m.procedural()) {
+				throw action_failed(
+				    "Dead end filling reads the whole maze, so it can't "
+				    "solve a procedural maze.");
 			}
-			std::cout << cell->x << ", " << cell->y << " -> " << cell->prev->x << ", " << cell->prev->y << std::endl;
-			cell = cell->prev;
+			solvers::dead_end_solver solver(m, scratch, _threads);
+			find_res = solver.solve(start_cell, finish_cell, path);
+			explored = solver.explored();
+			std::cout << "dead ends filled:" << solver.filled() << std::endl;
+		} break;
+		default:
+			break;
+		}
+		mark_path(m, path);
+		if (find_res) {
+			std::cout << "path length:" << path.size() - 1 << std::endl;
 		}
 	}
+	std::cout << "cells explored:" << explored << std::endl;
+	if (!find_res) {
+		std::cout << "Can not find maze path!" << std::endl;
+	}
 
 	auto finish_time = std::chrono::system_clock::now();
 	std::chrono::duration<double> total_time = finish_time - start_time;
 	std::cout << "path finding time:" << total_time.count() << std::endl;
+	scratch.report(std::cout, "path finding");
 
 	return m;
 }
 
+/**
+ * @param m the maze the cell is in
+ * @param x the x coordinate of the cell
+ * @param y the y coordinate of the cell
+ * @param fallback the cell to use when none was given
+ **/
+mazer2018::data::cell_id mazer2018::args::path_finding_action::endpoint(
+    const data::maze& m, int x, int y, data::cell_id fallback) {
+  if (x == constants::ERROR) return fallback;
+  if (!m.valid_cell(x, y) || !m.active(m.index(x, y))) {
+    std::ostringstream oss;
+    oss << "Error: " << x << "," << y << " is not a cell of the maze."
+        << std::endl;
+    throw action_failed(oss.str());
+  }
+  return m.index(x, y);
+}
+
 bool mazer2018::args::path_finding_action::cell_valid(int x, int y, int width, int height) {
 	return !(x < 0 || x >= width || y < 0 || y >= height);
 }
 
-bool mazer2018::args::path_finding_action::is_finish_cell(data::maze& m, data::cell *start_cell, data::cell *finish_cell) {
-	bool find_path = false;
-	std::stack<data::cell *> cell_stack;
+bool mazer2018::args::path_finding_action::is_finish_cell(const data::maze& m, data::traversal_context& context, data::cell_id start_cell, data::cell_id finish_cell, std::size_t& explored) {
+	std::stack<data::cell_id, data::arena_vector<data::cell_id>> cell_stack(
+		data::arena_vector<data::cell_id>(context.get_allocator()));
+	context.reset(m);
 	cell_stack.push(start_cell);
-	start_cell->is_visited = true;
+	context.visit(start_cell);
+	explored = 0;
 	while (!cell_stack.empty()) {
-		data::cell *cur_cell = cell_stack.top();
+		data::cell_id cur_cell = cell_stack.top();
 		cell_stack.pop();
-		for (int i = 0; i < cur_cell->adjacents.size(); i++) {
-			data::edge &cur_edge = cur_cell->adjacents[i];
-
-			if (!cell_valid(cur_edge.out_x, cur_edge.out_y, m.width(), m.height())) {
-				continue;
-			}
-			if (m.get_cells()[cur_edge.out_y][cur_edge.out_x].is_visited) {
-				continue;
+		++explored;
+		m.for_each_neighbour(cur_cell, [&](data::cell_id next_cell, data::direction dir) {
+			if (context.visited(next_cell)) {
+				return;
 			}
-			cell_stack.push(&(m.get_cells()[cur_edge.out_y][cur_edge.out_x]));
-			m.get_cells()[cur_edge.out_y][cur_edge.out_x].is_visited = true;
-			m.get_cells()[cur_edge.out_y][cur_edge.out_x].prev = cur_cell;
-		}
+			cell_stack.push(next_cell);
+			context.visit(next_cell, !dir);
+		});
 	}
-	data::cell *cur_cell = finish_cell;
-	while (cur_cell->prev != nullptr) {
-		for (int i = 0; i < cur_cell->prev->adjacents.size(); i++) {
-			data::edge &edge = cur_cell->prev->adjacents[i];
-			if (edge.out_x == cur_cell->x && edge.out_y == cur_cell->y) {
-				edge.is_solve = true;
-			}
-			if (cur_cell->prev->x == start_cell->x && cur_cell->prev->y == start_cell->y) {
-				find_path = true;
-			}
-		}
-		cur_cell = cur_cell->prev;
-	}
-	return find_path;
+	return context.visited(finish_cell);
 }
 
 
@@ -164,6 +497,28 @@ mazer2018::data::maze& mazer2018::args::save_action::do_action(
   return m;
 }
 
+mazer2018::data::maze& mazer2018::args::layout_action::do_action(
+    mazer2018::data::maze& m) {
+  m.layout(_type);
+  return m;
+}
+
+mazer2018::data::maze& mazer2018::args::mask_action::do_action(
+    mazer2018::data::maze& m) {
+  if (!m.load_mask(_name)) {
+    std::ostringstream oss;
+    oss << "There was an error loading the mask file " << _name << std::endl;
+    throw action_failed(oss.str());
+  }
+  return m;
+}
+
+mazer2018::data::maze& mazer2018::args::map_action::do_action(
+    mazer2018::data::maze& m) {
+  m.map_file(_name);
+  return m;
+}
+
 mazer2018::data::maze& mazer2018::args::load_action::do_action(
     mazer2018::data::maze& m) {
   if (!m.load_binary(_name)) {
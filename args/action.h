@@ -1,7 +1,14 @@
 #include <exception>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 #include "../constants/constants.h"
+#include "../data/arena.h"
+#include "../data/layout.h"
+#include "../data/traversal.h"
+#include "../data/types.h"
 
 #pragma once
 namespace mazer2018 {
@@ -10,7 +17,6 @@ namespace data {
  * forwards declaration required to avoid a recursive include
  **/
 class maze;
-struct cell;
 }  // namespace data
 namespace args {
 /**
@@ -19,6 +25,12 @@ namespace args {
  **/
 class action {
  public:
+  /**
+   * actions are owned through pointers to this class so they must be
+   * destroyed through it too
+   **/
+  virtual ~action(void) {}
+
   /**
    * pure virtual function that must be implemented in each
    * child class to describe how to perform the action
@@ -52,6 +64,67 @@ class action_failed : public std::exception {
   const char *what(void) { return std::move(_message.c_str()); }
 };
 
+/**
+ * how do we want to save a file? Binary or Svg?
+ **/
+enum class save_type {
+  /// save the file as binary
+  BINARY,
+  /// save the file as svg
+  SVG
+};
+
+/**
+ * the algorithm a generate action uses
+ **/
+enum class generator_type {
+  /// the growing tree algorithm, with a @ref growth_type
+  GROWING_TREE,
+  /// Kruskal's algorithm
+  KRUSKAL,
+  /// Wilson's algorithm, for uniform spanning tree mazes
+  WILSON,
+  /// Eller's algorithm, which can stream the maze a row at a time
+  ELLER,
+  /// recursive division
+  DIVISION,
+  /// the binary tree algorithm, which streams the maze a row at a time
+  BINARY_TREE,
+  /// the sidewinder algorithm, which streams the maze a row at a time
+  SIDEWINDER,
+  /// recursive division worked out a tile at a time as the maze is read
+  PROCEDURAL,
+  /// recursive division by building walls in an open maze a word at a time
+  DIVISION_WALLS
+};
+
+/**
+ * @return whether a generator makes the maze a row at a time, so that it
+ * can be streamed into files as it goes - see data::row_sink
+ **/
+inline bool streams_rows(generator_type type) {
+  return type == generator_type::ELLER ||
+         type == generator_type::BINARY_TREE ||
+         type == generator_type::SIDEWINDER;
+}
+
+/**
+ * how a growing tree generator picks the cell to grow from next - see
+ * generators/grow_policies.h
+ **/
+enum class growth_type {
+  /// the newest cell - the recursive backtracker
+  NEWEST,
+  /// a random cell - Prim's algorithm
+  RANDOM,
+  /// the oldest cell
+  OLDEST,
+  /// the newest cell for a percentage of picks, otherwise a random cell
+  MIXED,
+  /// a random cell among a number of the newest
+  WINDOW
+};
+
 /**
  * represents a request to generate a maze
  **/
@@ -73,10 +146,49 @@ class generate_action : public action {
    **/
   unsigned _height;
 
+  /**
+   * whether a @ref generator_type::DIVISION maze is divided from a single
+   * stack on the calling thread
+   **/
   bool stack;
 
-  // generator type
-  int _gen_type;
+  /**
+   * the algorithm to generate with
+   **/
+  generator_type _type;
+
+  /**
+   * how the growing tree generator picks the next cell
+   **/
+  growth_type _growth;
+
+  /**
+   * the percentage of newest picks for @ref growth_type::MIXED, the
+   * size of the window for @ref growth_type::WINDOW, the number of
+   * cells below which a @ref generator_type::DIVISION region is not
+   * divided as a task of its own, or the most tiles a
+   * @ref generator_type::PROCEDURAL maze holds at once
+   **/
+  int _param;
+
+  /**
+   * the number of threads to generate on, or 0 for one per core. It
+   * only changes how fast the maze is generated, never the maze itself.
+   **/
+  unsigned _threads;
+
+  /**
+   * whether a growing tree maze is built from tiles that are joined
+   * together rather than from a single frontier, set by --tiled
+   **/
+  bool _tiled;
+
+  /**
+   * the files a maze generated a row at a time is streamed into as it is
+   * generated - see @ref streams_rows. If there are none it is generated
+   * into the maze.
+   **/
+  std::vector<std::pair<save_type, std::string>> _streams;
 
  public:
   /**
@@ -90,21 +202,178 @@ class generate_action : public action {
    * creates a generate_action based on the seed, width and
    * height being specified
    **/
-  generate_action(int seed, unsigned width, unsigned height, bool use_stack, int type)
-      : _seed(seed), _width(width), _height(height), stack(use_stack), _gen_type(type) {}
+  generate_action(int seed, unsigned width, unsigned height, bool use_stack,
+                  generator_type type,
+                  growth_type growth = growth_type::NEWEST, int param = 0,
+                  unsigned threads = 1, bool tiled = false)
+      : _seed(seed),
+        _width(width),
+        _height(height),
+        stack(use_stack),
+        _type(type),
+        _growth(growth),
+        _param(param),
+        _threads(threads),
+        _tiled(tiled) {}
+
+  /**
+   * @return the number of threads to generate on, or 0 for one per core
+   **/
+  unsigned threads(void) const { return _threads; }
+
+  /**
+   * @return a copy of this action that generates from another seed on a
+   * single thread, without streaming into any files - one maze of a
+   * @ref batch_action
+   **/
+  generate_action with_seed(int seed) const {
+    generate_action copy(*this);
+    copy._seed = seed;
+    copy._threads = 1;
+    copy._streams.clear();
+    return copy;
+  }
+
+  /**
+   * asks for the maze to be streamed into a file as it is generated
+   * rather than being saved once it is complete
+   * @return false if this generator can't stream, in which case the
+   * file should be saved by a @ref save_action
+   **/
+  bool stream_to(save_type type, const std::string &name) {
+    if (!streams_rows(_type)) return false;
+    _streams.emplace_back(type, name);
+    return true;
+  }
 
   virtual data::maze &do_action(data::maze &);
 };
 
+/**
+ * represents a request to generate and save a maze for every seed of a
+ * range, in one process. The mazes are shared out over a pool of threads
+ * - the number given by --threads - and each thread generates its mazes
+ * one after another on a single thread into a maze of its own that it
+ * keeps reusing, so its buffers are only allocated once.
+ **/
+class batch_action : public action {
+  /**
+   * the first and last seeds to generate from
+   **/
+  int _from, _to;
+
+  /**
+   * the generate action each maze is generated by, with its seed replaced
+   **/
+  generate_action _generate;
+
+  /**
+   * the files each maze is saved to, with @ref SEED_FIELD in their names
+   * replaced by the seed
+   **/
+  std::vector<std::pair<save_type, std::string>> _saves;
+
+  /**
+   * @return the name of the file to save the maze of a seed to
+   **/
+  static std::string file_name(const std::string &pattern, int seed);
+
+ public:
+  /**
+   * the part of a file name that is replaced by the seed of each maze
+   **/
+  static const std::string SEED_FIELD;
+
+  /**
+   * constructor - assigns the range of seeds and the action that
+   * generates each maze
+   **/
+  batch_action(int from, int to, const generate_action &generate)
+      : _from(from), _to(to), _generate(generate) {}
+
+  /**
+   * asks for every maze of the batch to be saved. The name must hold
+   * @ref SEED_FIELD so that each maze has a file of its own.
+   **/
+  void save_to(save_type type, const std::string &name);
+
+  virtual data::maze &do_action(data::maze &);
+};
+
+/**
+ * the search a path finding action uses
+ **/
+enum class solver_type {
+  /// a depth first search, which finds a path but not always a shortest
+  /// one
+  DFS,
+  /// a breadth first search, which finds a shortest path
+  BFS,
+  /// an A* search, which finds a shortest path while exploring towards
+  /// the finish
+  ASTAR,
+  /// a breadth first search from each end at once, which finds a
+  /// shortest path where the two meet
+  BIDIRECTIONAL,
+  /// a breadth first search spread over several threads, which finds a
+  /// shortest path
+  PARALLEL_BFS,
+  /// dead end filling, which fills in the dead ends of the maze until
+  /// only the path is left
+  DEAD_END_FILL
+};
+
 /************************************************************************/
 /* maze path finding                                                                     */
 /************************************************************************/
 class path_finding_action : public action {
+  /**
+   * the search to use
+   **/
+  solver_type _solver;
+
+  /**
+   * the number of threads a parallel search or dead end filling uses, or
+   * 0 for one per core
+   **/
+  unsigned _threads;
+
+  /**
+   * the cells to find a path between, or constants::ERROR to go from the
+   * maze's first cell to its last
+   **/
+  int _start_x, _start_y, _goal_x, _goal_y;
+
+  /**
+   * @return the cell at x, y, or fallback if x is constants::ERROR
+   * @throw action_failed if the cell is not in use in the maze
+   **/
+  static data::cell_id endpoint(const data::maze &, int x, int y,
+                                data::cell_id fallback);
+
+ public:
+  /**
+   * constructor - assigns the search to use, the threads it may use and
+   * the cells to find a path between
+   **/
+  path_finding_action(solver_type solver = solver_type::DFS,
+                      unsigned threads = 1,
+                      int start_x = constants::ERROR,
+                      int start_y = constants::ERROR,
+                      int goal_x = constants::ERROR,
+                      int goal_y = constants::ERROR)
+      : _solver(solver),
+        _threads(threads),
+        _start_x(start_x),
+        _start_y(start_y),
+        _goal_x(goal_x),
+        _goal_y(goal_y) {}
+
 	virtual data::maze &do_action(data::maze &);
 
 private:
 	bool cell_valid(int x, int y, int width, int height);
-	bool is_finish_cell(data::maze& m, data::cell *cur_cell, data::cell *finish_cell);
+	bool is_finish_cell(const data::maze& m, data::traversal_context& context, data::cell_id start_cell, data::cell_id finish_cell, std::size_t& explored);
 
 };
 
@@ -128,13 +397,63 @@ class load_action : public action {
 };
 
 /**
- * how do we want to save a file? Binary or Svg?
+ * defines a request to change the order the cells of the maze are stored
+ * in. The current maze, if any, is converted and mazes generated after it
+ * use the same layout.
  **/
-enum class save_type {
-  /// save the file as binary
-  BINARY,
-  /// save the file as svg
-  SVG
+class layout_action : public action {
+  /**
+   * the layout to use
+   **/
+  data::layout_type _type;
+
+ public:
+  /**
+   * constructor - just assigns the layout to use
+   **/
+  layout_action(data::layout_type type) : _type(type) {}
+
+  virtual data::maze &do_action(data::maze &);
+};
+
+/**
+ * defines a request to hold the maze in a memory mapped file. The current
+ * maze, if any, is copied into the file and mazes generated after it are
+ * written straight into it.
+ **/
+class map_action : public action {
+  /**
+   * the name of the file to map
+   **/
+  std::string _name;
+
+ public:
+  /**
+   * constructor - just assigns the file name
+   **/
+  map_action(const std::string &name) : _name(name) {}
+
+  virtual data::maze &do_action(data::maze &);
+};
+
+/**
+ * defines a request to cut the maze out of a shape. The mask is loaded
+ * from a pbm file and the next maze generated fills the black pixels of
+ * the bitmap.
+ **/
+class mask_action : public action {
+  /**
+   * the name of the pbm file holding the mask
+   **/
+  std::string _name;
+
+ public:
+  /**
+   * constructor - just assigns the file name
+   **/
+  mask_action(const std::string &name) : _name(name) {}
+
+  virtual data::maze &do_action(data::maze &);
 };
 
 /**
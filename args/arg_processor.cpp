@@ -1,15 +1,31 @@
 #include "arg_processor.h"
+#include "../generators/procedural_generator.h"
+#include "../generators/recursivegen.h"
 // array of valid argument strings that can be passed in from the
 // command line
 const std::string mazer2018::args::arg_processor::arg_strings
     [mazer2018::args::arg_processor::NUM_OPTIONS] = {"--gr", "--gp", "--pm", "--sv",
-                                                     "--sb", "--lb"};
+                                                     "--sb", "--lb", "--layout",
+                                                     "--mm", "--mask", "--gt",
+                                                     "--threads", "--gk", "--gw", "--ge",
+                                                     "--g", "--gs", "--cutoff",
+                                                     "--gb", "--gsw", "--batch",
+                                                     "--gl", "--tiles", "--gwb",
+                                                     "--solver", "--tiled"};
 
 /**
  * constructor - simply copies the arguments passed in from the command line
  * into a vector for later processing
  **/
-mazer2018::args::arg_processor::arg_processor(int argc, char* argv[]) {
+mazer2018::args::arg_processor::arg_processor(int argc, char* argv[])
+    : threads(1),
+      cutoff(int(generators::recursivegen::DEFAULT_CUTOFF)),
+      tiles(int(generators::procedural_generator::DEFAULT_TILES)),
+      solver(solver_type::DFS),
+      tiled(false),
+      batch(false),
+      batch_from(0),
+      batch_to(0) {
   int count;
   for (count = 1; count < argc; ++count) {
     arguments.push_back(argv[count]);
@@ -43,7 +59,19 @@ mazer2018::args::arg_processor::process(void) {
         option_type type = option_type(opt_count);
         // if we are not generating, there should be one argument
         // for the option
-        if (type != option_type::GENERATE_RECURSIVE && type != option_type::GENERATE_PRIME && type != option_type::PATH_FINDING) {
+        if (type != option_type::GENERATE_RECURSIVE && type != option_type::GENERATE_PRIME && type != option_type::PATH_FINDING &&
+            type != option_type::GENERATE_TREE &&
+            type != option_type::GENERATE_KRUSKAL &&
+            type != option_type::GENERATE_WILSON &&
+            type != option_type::GENERATE_ELLER &&
+            type != option_type::GENERATE_DIVISION &&
+            type != option_type::GENERATE_DIVISION_STACK &&
+            type != option_type::GENERATE_BINARY_TREE &&
+            type != option_type::GENERATE_SIDEWINDER &&
+            type != option_type::BATCH &&
+            type != option_type::GENERATE_PROCEDURAL &&
+            type != option_type::GENERATE_DIVISION_WALLS &&
+            type != option_type::TILED) {
           int distance = find_next_option(arguments, arg_count);
           if (distance != ONE_ARGUMENT) {
             std::ostringstream oss;
@@ -59,7 +87,9 @@ mazer2018::args::arg_processor::process(void) {
             // a generate action was requested - we
             // implement this processing in a different
             // function
-            newact = process_generate_argument(arg_count, false, 0);
+            newact = process_generate_argument(
+                arg_count, false, generator_type::GROWING_TREE,
+                growth_type::NEWEST);
             // need to move the unique_ptr onto the vector
             // as it is a move only type
             actions.push_back(std::move(newact));
@@ -67,16 +97,16 @@ mazer2018::args::arg_processor::process(void) {
           case option_type::GENERATE_PRIME: {
             // a generate action using the stack method
             // has been requested
-            newact = process_generate_argument(arg_count, true, 1);
+            newact = process_generate_argument(
+                arg_count, true, generator_type::GROWING_TREE,
+                growth_type::RANDOM);
             actions.push_back(std::move(newact));
             break;
           }
 		  case option_type::PATH_FINDING: {
-			  // a generate action using the stack method
-			  // has been requested
-			  newact = std::make_unique<path_finding_action>();
+			  // a path finding action, optionally between two cells
+			  newact = process_path_finding(arg_count);
 			  actions.push_back(std::move(newact));
-			  arg_count--;
 			  break;
 		  }
           case option_type::SAVE_VECTOR: {
@@ -88,6 +118,7 @@ mazer2018::args::arg_processor::process(void) {
                   "svg files must have "
                   "a .svg extension");
             }
+            if (stream_save(save_type::SVG, name)) break;
             // create a save action that will store
             // this request
             std::unique_ptr<action> newact = std::make_unique<save_action>(
@@ -95,6 +126,7 @@ mazer2018::args::arg_processor::process(void) {
             actions.push_back(std::move(newact));
           } break;
           case option_type::SAVE_BINARY: {
+            if (stream_save(save_type::BINARY, arguments[arg_count])) break;
             // create a save action that will store this
             // request
             std::unique_ptr<action> newact = std::make_unique<save_action>(
@@ -108,6 +140,173 @@ mazer2018::args::arg_processor::process(void) {
                 std::make_unique<load_action>(arguments[arg_count]);
             actions.push_back(std::move(newact));
           } break;
+          case option_type::LAYOUT: {
+            // create a layout action for the layout named
+            std::unique_ptr<action> newact = std::make_unique<layout_action>(
+                process_layout(arguments[arg_count]));
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::MAP_FILE: {
+            // create a map action for the file named
+            std::unique_ptr<action> newact =
+                std::make_unique<map_action>(arguments[arg_count]);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::MASK: {
+            // create a mask action for the bitmap named
+            std::unique_ptr<action> newact =
+                std::make_unique<mask_action>(arguments[arg_count]);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_TREE: {
+            // the first argument names the policy and the rest are the
+            // same as for any other generate action
+            if (find_next_option(arguments, arg_count) == 0) {
+              throw action_failed(
+                  "the --gt action needs the name of a growing tree "
+                  "policy");
+            }
+            int param;
+            growth_type growth = process_growth(arguments[arg_count], param);
+            ++arg_count;
+            newact = process_generate_argument(
+                arg_count, false, generator_type::GROWING_TREE, growth, param);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::THREADS: {
+            // not an action of its own - it changes the generate actions
+            // that follow it
+            int count = constants::ERROR;
+            try {
+              count = stoi(arguments[arg_count]);
+            } catch (std::exception& e) {
+            }
+            if (count < 0 || count > MAX_THREADS) {
+              std::ostringstream oss;
+              oss << "Error: the number of threads must be from 0 (one per "
+                  << "core) to " << MAX_THREADS << "." << std::endl;
+              throw action_failed(oss.str());
+            }
+            threads = unsigned(count);
+          } break;
+          case option_type::GENERATE_KRUSKAL: {
+            newact = process_generate_argument(arg_count, false,
+                                               generator_type::KRUSKAL);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_WILSON: {
+            newact = process_generate_argument(arg_count, false,
+                                               generator_type::WILSON);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_ELLER: {
+            newact = process_generate_argument(arg_count, false,
+                                               generator_type::ELLER);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_DIVISION: {
+            newact = process_generate_argument(
+                arg_count, false, generator_type::DIVISION,
+                growth_type::NEWEST, cutoff);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_DIVISION_STACK: {
+            newact = process_generate_argument(
+                arg_count, true, generator_type::DIVISION,
+                growth_type::NEWEST, cutoff);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::CUTOFF: {
+            // like --threads, it changes the generate actions that follow
+            // it
+            int cells = constants::ERROR;
+            try {
+              cells = stoi(arguments[arg_count]);
+            } catch (std::exception& e) {
+            }
+            if (cells < 1) {
+              std::ostringstream oss;
+              oss << "Error: the cutoff must be a number of cells from 1 "
+                  << "up." << std::endl;
+              throw action_failed(oss.str());
+            }
+            cutoff = cells;
+          } break;
+          case option_type::GENERATE_BINARY_TREE: {
+            newact = process_generate_argument(arg_count, false,
+                                               generator_type::BINARY_TREE);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::GENERATE_SIDEWINDER: {
+            newact = process_generate_argument(arg_count, false,
+                                               generator_type::SIDEWINDER);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::BATCH: {
+            // not an action of its own - it turns the generate action
+            // after it into a batch
+            int from = 0, to = -1;
+            if (find_next_option(arguments, arg_count) == BATCH_ARGUMENTS) {
+              try {
+                from = stoi(arguments[arg_count++]);
+                to = stoi(arguments[arg_count]);
+              } catch (std::exception& e) {
+                to = -1;
+              }
+            }
+            if (from < 0 || to < from) {
+              std::ostringstream oss;
+              oss << "Error: --batch needs the first and last seeds of the "
+                  << "batch, from 0 up." << std::endl;
+              throw action_failed(oss.str());
+            }
+            batch = true;
+            batch_from = from;
+            batch_to = to;
+          } break;
+          case option_type::GENERATE_PROCEDURAL: {
+            newact = process_generate_argument(
+                arg_count, false, generator_type::PROCEDURAL,
+                growth_type::NEWEST, tiles);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::TILES: {
+            // like --cutoff, it changes the generate actions that follow
+            // it
+            int count = constants::ERROR;
+            try {
+              count = stoi(arguments[arg_count]);
+            } catch (std::exception& e) {
+            }
+            if (count < 1) {
+              std::ostringstream oss;
+              oss << "Error: the number of tiles must be from 1 up."
+                  << std::endl;
+              throw action_failed(oss.str());
+            }
+            tiles = count;
+          } break;
+          case option_type::GENERATE_DIVISION_WALLS: {
+            newact = process_generate_argument(
+                arg_count, false, generator_type::DIVISION_WALLS);
+            actions.push_back(std::move(newact));
+          } break;
+          case option_type::SOLVER: {
+            // like --threads, it changes the path finding actions that
+            // follow it
+            solver = process_solver(arguments[arg_count]);
+          } break;
+          case option_type::TILED: {
+            // like --threads, it changes the generate actions that follow
+            // it, but takes no arguments
+            if (find_next_option(arguments, arg_count) != 0) {
+              throw action_failed("--tiled takes no arguments.");
+            }
+            // there was nothing to consume, so step back to leave the next
+            // option for the caller
+            --arg_count;
+            tiled = true;
+          } break;
         }
         break;
       }
@@ -144,6 +343,63 @@ std::string mazer2018::args::option_string(mazer2018::args::option_type type) {
     case option_type::LOAD_BINARY:
       return "load binary";
       break;
+    case option_type::LAYOUT:
+      return "layout";
+      break;
+    case option_type::MAP_FILE:
+      return "map file";
+      break;
+    case option_type::MASK:
+      return "mask";
+      break;
+    case option_type::GENERATE_TREE:
+      return "generate growing tree";
+      break;
+    case option_type::THREADS:
+      return "threads";
+      break;
+    case option_type::GENERATE_KRUSKAL:
+      return "generate kruskal";
+      break;
+    case option_type::GENERATE_WILSON:
+      return "generate wilson";
+      break;
+    case option_type::GENERATE_ELLER:
+      return "generate eller";
+      break;
+    case option_type::GENERATE_DIVISION:
+      return "generate recursive division";
+      break;
+    case option_type::GENERATE_DIVISION_STACK:
+      return "generate recursive division with a stack";
+      break;
+    case option_type::CUTOFF:
+      return "cutoff";
+      break;
+    case option_type::GENERATE_BINARY_TREE:
+      return "generate binary tree";
+      break;
+    case option_type::GENERATE_SIDEWINDER:
+      return "generate sidewinder";
+      break;
+    case option_type::BATCH:
+      return "batch";
+      break;
+    case option_type::GENERATE_PROCEDURAL:
+      return "generate procedural recursive division";
+      break;
+    case option_type::TILES:
+      return "tiles";
+      break;
+    case option_type::GENERATE_DIVISION_WALLS:
+      return "generate recursive division with walls";
+      break;
+    case option_type::SOLVER:
+      return "solver";
+      break;
+    case option_type::TILED:
+      return "tiled";
+      break;
   }
   return "Invalid";
 }
@@ -175,14 +431,143 @@ bool mazer2018::args::arg_processor::valid_dim(int val) {
   return true;
 }
 
+/**
+ * a streamed maze is never held in memory, so it only needs memory for one
+ * row. It is still held to the cells a maze may have, so that a binary
+ * file it is saved to can be loaded back.
+ **/
+bool mazer2018::args::arg_processor::valid_stream_dim(int width,
+                                                      int height) {
+  return height >= MINDIM &&
+         std::int64_t(width) * height <= constants::MAX_CELLS;
+}
+
+/**
+ * @param type the kind of file to save
+ * @param name the name of the file to save
+ * @return true if the last action is a generate action that streams
+ * the maze into the file as it is generated, or a batch that saves each
+ * of its mazes to a file named after it
+ **/
+bool mazer2018::args::arg_processor::stream_save(save_type type,
+                                                 const std::string& name) {
+  if (actions.empty()) return false;
+  batch_action* batch = dynamic_cast<batch_action*>(actions.back().get());
+  if (batch) {
+    batch->save_to(type, name);
+    return true;
+  }
+  generate_action* generate =
+      dynamic_cast<generate_action*>(actions.back().get());
+  return generate && generate->stream_to(type, name);
+}
+
 /************************************************************************/
 /* maze path finding                                                                     */
 /************************************************************************/
+/**
+ * --pm either takes no arguments, to find a path from the first cell of
+ * the maze to the last, or the x and y of the cells to start and finish
+ * at. Whether the cells are in the maze is only known once it exists.
+ **/
 std::unique_ptr<mazer2018::args::action>
-mazer2018::args::arg_processor::process_path_finding() {
-	std::unique_ptr<action> newact;
-	newact = std::make_unique<path_finding_action>();
-	return std::move(newact);
+mazer2018::args::arg_processor::process_path_finding(int& arg_count) {
+	int distance = find_next_option(arguments, arg_count);
+	if (distance == 0) {
+		// there was nothing to consume, so step back to leave the next
+		// option for the caller
+		--arg_count;
+		return std::make_unique<path_finding_action>(solver, threads);
+	}
+	int cells[PATH_ARGUMENTS];
+	bool valid = distance == PATH_ARGUMENTS;
+	for (int i = 0; valid && i < PATH_ARGUMENTS; ++i) {
+		try {
+			cells[i] = stoi(arguments[arg_count + i]);
+		} catch (std::exception& e) {
+			valid = false;
+		}
+	}
+	if (!valid) {
+		std::ostringstream oss;
+		oss << "Error: --pm takes either no arguments or the x and y of the "
+		    << "cells to start and finish at." << std::endl;
+		throw action_failed(oss.str());
+	}
+	arg_count += PATH_ARGUMENTS - 1;
+	return std::make_unique<path_finding_action>(solver, threads, cells[0],
+	                                             cells[1], cells[2], cells[3]);
+}
+
+/**
+ * @param name the name of the solver: dfs, bfs, astar, bidir, parallel or
+ * fill
+ **/
+mazer2018::args::solver_type mazer2018::args::arg_processor::process_solver(
+    const std::string& name) {
+  if (name == "dfs") return solver_type::DFS;
+  if (name == "bfs") return solver_type::BFS;
+  if (name == "astar") return solver_type::ASTAR;
+  if (name == "bidir") return solver_type::BIDIRECTIONAL;
+  if (name == "parallel") return solver_type::PARALLEL_BFS;
+  if (name == "fill") return solver_type::DEAD_END_FILL;
+  std::ostringstream oss;
+  oss << "Error: " << name << " is not a valid solver. Valid solvers are "
+      << "dfs, bfs, astar, bidir, parallel and fill." << std::endl;
+  throw action_failed(oss.str());
+}
+
+/**
+ * @param name the name of the layout: row, tiled8, tiled64 or morton
+ **/
+mazer2018::data::layout_type mazer2018::args::arg_processor::process_layout(
+    const std::string& name) {
+  if (name == "row") return data::layout_type::ROW_MAJOR;
+  if (name == "tiled8") return data::layout_type::TILED_8;
+  if (name == "tiled64") return data::layout_type::TILED_64;
+  if (name == "morton") return data::layout_type::MORTON;
+  std::ostringstream oss;
+  oss << "Error: " << name << " is not a valid layout. Valid layouts "
+      << "are row, tiled8, tiled64 and morton." << std::endl;
+  throw action_failed(oss.str());
+}
+
+/**
+ * @param name the name of the policy: newest, random, oldest, mixed or
+ * window, where mixed may be followed by :percent and window by :size
+ * @param param set to the percentage of newest picks for mixed or the
+ * size of the window for window
+ **/
+mazer2018::args::growth_type mazer2018::args::arg_processor::process_growth(
+    const std::string& name, int& param) {
+  std::string::size_type colon = name.find(':');
+  std::string base = name.substr(0, colon);
+  param = 0;
+  bool has_param = colon != std::string::npos;
+  if (has_param) {
+    try {
+      param = stoi(name.substr(colon + 1));
+    } catch (std::exception& e) {
+      has_param = false;
+      param = constants::ERROR;
+    }
+  }
+  if (base == "newest" && !has_param) return growth_type::NEWEST;
+  if (base == "random" && !has_param) return growth_type::RANDOM;
+  if (base == "oldest" && !has_param) return growth_type::OLDEST;
+  if (base == "mixed" && param >= 0 && param <= 100) {
+    if (!has_param) param = DEFAULT_MIX;
+    return growth_type::MIXED;
+  }
+  if (base == "window" && param >= 0) {
+    if (!has_param) param = DEFAULT_WINDOW;
+    if (param > 0) return growth_type::WINDOW;
+  }
+  std::ostringstream oss;
+  oss << "Error: " << name << " is not a valid growing tree policy. Valid "
+      << "policies are newest, random, oldest, mixed[:percent] and "
+      << "window[:size]." << std::endl;
+  throw action_failed(oss.str());
 }
 
 /**
@@ -192,7 +577,10 @@ mazer2018::args::arg_processor::process_path_finding() {
  **/
 std::unique_ptr<mazer2018::args::action>
 mazer2018::args::arg_processor::process_generate_argument(int& arg_count,
-                                                          bool use_stack, int gen_type) {
+                                                          bool use_stack,
+                                                          generator_type gen,
+                                                          growth_type growth,
+                                                          int param) {
   // this function returns a std::unique_ptr so that the memory will be
   // freed when it goes out of scope
   std::unique_ptr<action> newact;
@@ -212,6 +600,9 @@ mazer2018::args::arg_processor::process_generate_argument(int& arg_count,
       seed = constants::ERROR;
       width = constants::DEFAULT_WIDTH;
       height = constants::DEFAULT_HEIGHT;
+      // there was nothing to consume, so step back to leave the next
+      // option for the caller
+      --arg_count;
       break;
     }
     case generate_type::NODIMS: {
@@ -246,7 +637,9 @@ mazer2018::args::arg_processor::process_generate_argument(int& arg_count,
       // we need to validate that these are
       // values within the range of valid widths
       // / heights
-      if (!valid_dim(width) || !valid_dim(height)) {
+      if (!valid_dim(width) ||
+          !(streams_rows(gen) ? valid_stream_dim(width, height)
+                                         : valid_dim(height))) {
         std::string message =
             "the dimension provided for a maze"
             " are out of range";
@@ -270,6 +663,14 @@ mazer2018::args::arg_processor::process_generate_argument(int& arg_count,
             << "a generation request." << std::endl;
         throw action_failed(oss.str());
       }
+      // a streamed maze is never held in memory, but a binary file it is
+      // saved to still has to load back
+      if (streams_rows(gen) &&
+          std::int64_t(width) * height > constants::MAX_CELLS) {
+        throw action_failed(
+            "the dimension provided for a maze"
+            " are out of range");
+      }
       break;
     }
     default: {
@@ -279,6 +680,14 @@ mazer2018::args::arg_processor::process_generate_argument(int& arg_count,
       throw action_failed("invalid generation request");
     }
   }
-  newact = std::make_unique<generate_action>(seed, width, height, use_stack, gen_type);
+  generate_action generate(seed, width, height, use_stack, gen, growth, param,
+                           threads, tiled);
+  if (batch) {
+    // the seed of each maze of a batch comes from the batch
+    batch = false;
+    newact = std::make_unique<batch_action>(batch_from, batch_to, generate);
+  } else {
+    newact = std::make_unique<generate_action>(generate);
+  }
   return std::move(newact);
 }
@@ -31,7 +31,46 @@ enum class option_type {
   /// an action to save a maze as a binary file
   SAVE_BINARY,
   /// an action to load a maze from a binary file
-  LOAD_BINARY
+  LOAD_BINARY,
+  /// an action to choose the memory layout of the maze
+  LAYOUT,
+  /// an action to hold the maze in a memory mapped file
+  MAP_FILE,
+  /// an action to cut the maze out of a mask
+  MASK,
+  /// an action to generate a maze with a growing tree policy
+  GENERATE_TREE,
+  /// sets the number of threads later generate actions use
+  THREADS,
+  /// an action to generate a maze with Kruskal's algorithm
+  GENERATE_KRUSKAL,
+  /// an action to generate a maze with Wilson's algorithm
+  GENERATE_WILSON,
+  /// an action to generate a maze with Eller's algorithm
+  GENERATE_ELLER,
+  /// an action to generate a maze by recursive division
+  GENERATE_DIVISION,
+  /// an action to generate a maze by recursive division from one stack
+  GENERATE_DIVISION_STACK,
+  /// sets the region size below which later recursive divisions stop
+  /// spawning tasks
+  CUTOFF,
+  /// an action to generate a maze with the binary tree algorithm
+  GENERATE_BINARY_TREE,
+  /// an action to generate a maze with the sidewinder algorithm
+  GENERATE_SIDEWINDER,
+  /// turns the next generate action into a batch over a range of seeds
+  BATCH,
+  /// an action to make a procedural recursive division maze
+  GENERATE_PROCEDURAL,
+  /// sets the most tiles later procedural mazes hold at once
+  TILES,
+  /// an action to generate a maze by building recursive division walls
+  GENERATE_DIVISION_WALLS,
+  /// sets the search later path finding actions use
+  SOLVER,
+  /// makes later growing tree mazes from tiles that are joined together
+  TILED
 };
 
 /**
@@ -69,6 +108,41 @@ class arg_processor {
    * vector of arguments passed in from the command line
    **/
   std::vector<std::string> arguments;
+  /**
+   * the number of threads generate actions and parallel or dead end
+   * filling path finding actions use, set by --threads. It applies to every such action after
+   * it on the command line.
+   **/
+  unsigned threads;
+  /**
+   * the number of cells below which a recursive division region is not
+   * divided as a task of its own, set by --cutoff. It applies to every
+   * generate action after it on the command line.
+   **/
+  int cutoff;
+  /**
+   * the most tiles a procedural maze holds at once, set by --tiles. It
+   * applies to every generate action after it on the command line.
+   **/
+  int tiles;
+  /**
+   * the search path finding actions use, set by --solver. It applies to
+   * every path finding action after it on the command line.
+   **/
+  solver_type solver;
+  /**
+   * whether growing tree mazes are built from tiles, set by --tiled. It
+   * applies to every generate action after it on the command line.
+   **/
+  bool tiled;
+  /**
+   * whether the next generate action is a batch, set by --batch
+   **/
+  bool batch;
+  /**
+   * the first and last seeds of the batch
+   **/
+  int batch_from, batch_to;
 
   /**
    * used to find the next option value for use with options
@@ -78,18 +152,29 @@ class arg_processor {
   /// the minimum size of a dimension
   static const int MINDIM = 4;
   /// the maximum size of a dimension
-  static const int MAXDIM = 5000;
+  static const int MAXDIM = constants::MAX_DIM;
   /// the length of a file extension of ".svg"
   static const int EXTLEN = 4;
   /// if we are passed a request for something other than
   /// generation there should be exactly one argument
   static const int ONE_ARGUMENT = 1;
+  /// the percentage of newest picks when a mixed policy gives none
+  static const int DEFAULT_MIX = 50;
+  /// the size of the window when a window policy gives none
+  static const int DEFAULT_WINDOW = 8;
+  /// the most threads that may be asked for
+  static const int MAX_THREADS = 1024;
+  /// the number of arguments --batch takes
+  static const int BATCH_ARGUMENTS = 2;
+  /// the number of arguments --pm takes when it is given the cells to
+  /// find a path between
+  static const int PATH_ARGUMENTS = 4;
 
  public:
   /**
    * the number of different command line options available
    **/
-  static const int NUM_OPTIONS = 6;
+  static const int NUM_OPTIONS = 25;
   /**
    * the command line options that are available to be used
    **/
@@ -108,15 +193,41 @@ class arg_processor {
   std::vector<std::unique_ptr<mazer2018::args::action> > process(void);
   /// validate that a maze dimension is valid
   static bool valid_dim(int);
+  /// validate the height of a maze of a valid width that is streamed
+  /// rather than held in memory
+  static bool valid_stream_dim(int, int);
+  /**
+   * hands a save to the generate action before it if that action can
+   * stream the maze into the file, or to the batch before it
+   **/
+  bool stream_save(save_type, const std::string&);
   /**
    * processes a generate request from the command line
    **/
-  std::unique_ptr<action> process_generate_argument(int&, bool, int gen_type);
+  std::unique_ptr<action> process_generate_argument(
+      int&, bool, generator_type, growth_type = growth_type::NEWEST,
+      int param = 0);
 
   /*
   maze path finding
   */
-  std::unique_ptr<action> process_path_finding();
+  std::unique_ptr<action> process_path_finding(int&);
+
+  /**
+   * processes the name of a cell layout passed in from the command line
+   **/
+  static data::layout_type process_layout(const std::string&);
+
+  /**
+   * processes the name of a solver passed in from the command line
+   **/
+  static solver_type process_solver(const std::string&);
+
+  /**
+   * processes the name of a growing tree policy passed in from the
+   * command line, along with its parameter if it has one
+   **/
+  static growth_type process_growth(const std::string&, int& param);
 };
 }  // namespace args
 }  // namespace mazer2018
@@ -0,0 +1,221 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include "../args/action.h"
+#include "../data/maze.h"
+#include "../generators/recursive_generator.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file layout_bench.cpp compares the cell layouts of a maze. For each
+ * layout it times a depth first generation, the depth first solver and a
+ * random walk over the passages of the maze, and where the kernel allows
+ * it reports the cache and TLB misses of each phase from the hardware
+ * performance counters.
+ **/
+
+namespace {
+/**
+ * a group of hardware counters measuring one phase of the benchmark. When
+ * the counters are not available (not linux, or perf_event_paranoid
+ * forbids it) only the time is reported.
+ **/
+class counters {
+  /// the events we count: cache references, cache misses, dTLB misses
+  static const int NUM_EVENTS = 3;
+  /// the file descriptor for each event or -1 if it could not be opened
+  int _fds[NUM_EVENTS];
+  /// the start of the measured phase
+  std::chrono::steady_clock::time_point _start;
+  /// the counter values read at the end of the phase
+  long long _values[NUM_EVENTS];
+  /// the duration of the phase in seconds
+  double _seconds;
+
+#ifdef __linux__
+  /**
+   * opens a counter for the calling thread
+   **/
+  static int open_event(std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+
+ public:
+  counters(void) : _seconds(0) {
+    for (int i = 0; i < NUM_EVENTS; ++i) {
+      _fds[i] = -1;
+      _values[i] = 0;
+    }
+#ifdef __linux__
+    _fds[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+    _fds[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    _fds[2] = open_event(PERF_TYPE_HW_CACHE,
+                         PERF_COUNT_HW_CACHE_DTLB |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+  }
+
+  ~counters(void) {
+#ifdef __linux__
+    for (int fd : _fds) {
+      if (fd >= 0) close(fd);
+    }
+#endif
+  }
+
+  /**
+   * starts measuring a phase
+   **/
+  void start(void) {
+#ifdef __linux__
+    for (int fd : _fds) {
+      if (fd < 0) continue;
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    _start = std::chrono::steady_clock::now();
+  }
+
+  /**
+   * stops measuring a phase and records the results
+   **/
+  void stop(void) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - _start;
+    _seconds = elapsed.count();
+#ifdef __linux__
+    for (int i = 0; i < NUM_EVENTS; ++i) {
+      if (_fds[i] < 0) continue;
+      ioctl(_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(_fds[i], &_values[i], sizeof(_values[i])) !=
+          sizeof(_values[i])) {
+        _values[i] = 0;
+      }
+    }
+#endif
+  }
+
+  /**
+   * prints one row of the results table
+   **/
+  void report(const std::string& layout, const std::string& phase) const {
+    std::cout << std::left << std::setw(10) << layout << std::setw(10)
+              << phase << std::right << std::setw(10) << std::fixed
+              << std::setprecision(3) << _seconds;
+    if (_fds[0] < 0 || _fds[1] < 0) {
+      std::cout << std::setw(14) << "n/a" << std::setw(10) << "n/a";
+    } else {
+      double rate = _values[0] ? 100.0 * _values[1] / _values[0] : 0;
+      std::cout << std::setw(14) << _values[1] << std::setw(9)
+                << std::setprecision(1) << rate << "%";
+    }
+    if (_fds[2] < 0) {
+      std::cout << std::setw(14) << "n/a";
+    } else {
+      std::cout << std::setw(14) << _values[2];
+    }
+    std::cout << std::endl;
+  }
+};
+
+/**
+ * walks randomly along the passages of the maze for the number of steps
+ * specified. This is the access pattern of the growing tree and depth
+ * first algorithms without any of their bookkeeping.
+ * @return the cell the walk finished on so the walk cannot be optimised
+ * away
+ **/
+mazer2018::data::cell_id random_walk(const mazer2018::data::maze& m,
+                                     long steps, int seed) {
+  using namespace mazer2018::data;
+  std::mt19937 rndgen(seed);
+  cell_id cur = m.index(0, 0);
+  cell_id options[num_dirs];
+  for (long count = 0; count < steps; ++count) {
+    int num_options = 0;
+    m.for_each_neighbour(cur, [&](cell_id next, direction) {
+      options[num_options++] = next;
+    });
+    cur = options[rndgen() % num_options];
+  }
+  return cur;
+}
+}  // namespace
+
+/**
+ * usage: mazer_bench [width height [seed]]
+ **/
+int main(int argc, char** argv) {
+  using namespace mazer2018;
+  int width = 2000, height = 2000, seed = 1;
+  if (argc >= 3) {
+    width = std::atoi(argv[1]);
+    height = std::atoi(argv[2]);
+  }
+  if (argc >= 4) seed = std::atoi(argv[3]);
+  const long WALK_STEPS = 10 * long(width) * height;
+  const std::pair<data::layout_type, std::string> layouts[] = {
+      {data::layout_type::ROW_MAJOR, "row"},
+      {data::layout_type::TILED_8, "tiled8"},
+      {data::layout_type::TILED_64, "tiled64"},
+      {data::layout_type::MORTON, "morton"}};
+
+  std::cout << "maze " << width << "x" << height << ", seed " << seed
+            << std::endl;
+  std::cout << std::left << std::setw(10) << "layout" << std::setw(10)
+            << "phase" << std::right << std::setw(10) << "seconds"
+            << std::setw(14) << "cache-misses" << std::setw(10) << "rate"
+            << std::setw(14) << "dtlb-misses" << std::endl;
+  counters counter;
+  for (const auto& layout : layouts) {
+    data::maze m;
+    m.layout(layout.first);
+    // the generator and solver report their own timings which would
+    // break up the table so silence them while they run
+    std::streambuf* old = std::cout.rdbuf(nullptr);
+    counter.start();
+    generators::recursive_generator generator(m, seed, width, height);
+    generator.generate();
+    counter.stop();
+    std::cout.rdbuf(old);
+    counter.report(layout.second, "generate");
+
+    old = std::cout.rdbuf(nullptr);
+    std::unique_ptr<args::action> solver =
+        std::make_unique<args::path_finding_action>();
+    counter.start();
+    solver->do_action(m);
+    counter.stop();
+    std::cout.rdbuf(old);
+    counter.report(layout.second, "solve");
+
+    counter.start();
+    data::cell_id end = random_walk(m, WALK_STEPS, seed);
+    counter.stop();
+    counter.report(layout.second, "walk");
+    if (end < 0) return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
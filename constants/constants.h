@@ -3,6 +3,7 @@
  * Created by Paul Miller as part of the assignment 1 solution for
  * COSC1252/COSC1254 - Programming Using C++, semester 2, 2018.
  **/
+#include <cstdint>
 #pragma once
 /**
  * the base namespace for this project
@@ -39,8 +40,15 @@ const unsigned DEFAULT_HEIGHT = 10;
 const int MIN_DIM = 2;
 
 /**
- * maximum value for width or height
+ * maximum value for width or height. A maze this size has ten billion
+ * cells and needs 2.5GB for its passages.
  **/
-const int MAX_DIM = 5000;
+const int MAX_DIM = 100000;
+
+/**
+ * the most cells a maze may have. A maze that is streamed a row at a time
+ * may be taller than MAX_DIM, but no bigger than this.
+ **/
+const std::int64_t MAX_CELLS = std::int64_t(MAX_DIM) * MAX_DIM;
 }  // namespace constants
 }  // namespace mazer2018
@@ -0,0 +1,48 @@
+#include "arena.h"
+#include <algorithm>
+#include <ostream>
+
+mazer2018::data::arena::arena(void)
+    : _next(nullptr),
+      _end(nullptr),
+      _block_size(FIRST_BLOCK),
+      _allocations(0),
+      _recycled(0),
+      _reserved(0) {
+  std::fill(_free, _free + MAX_RECYCLED / GRANULE, nullptr);
+}
+
+/**
+ * @param bytes the size of the allocation that did not fit in the current
+ * block
+ **/
+void* mazer2018::data::arena::grow(std::size_t bytes) {
+  // a big allocation gets a block of its own so that the rest of the
+  // current block is not wasted
+  if (bytes > _block_size / 2) {
+    _blocks.emplace_back(new char[bytes]);
+    _reserved += bytes;
+    return _blocks.back().get();
+  }
+  _blocks.emplace_back(new char[_block_size]);
+  _reserved += _block_size;
+  _next = _blocks.back().get();
+  _end = _next + _block_size;
+  // each block is twice the size of the last so the number of blocks
+  // grows with the log of the memory used
+  _block_size = std::min(_block_size * 2, std::size_t(MAX_BLOCK));
+  void* p = _next;
+  _next += bytes;
+  return p;
+}
+
+/**
+ * @param out the stream to write to
+ * @param what the name of the run the arena belonged to
+ **/
+void mazer2018::data::arena::report(std::ostream& out,
+                                    const char* what) const {
+  out << what << " scratch memory: " << _allocations << " allocations ("
+      << _recycled << " reused) from " << _blocks.size()
+      << " heap blocks of " << _reserved << " bytes" << std::endl;
+}
@@ -0,0 +1,189 @@
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#pragma once
+/**
+ * @file arena.h defines the arena that generators and solvers allocate
+ * their scratch data from.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * a monotonic arena for the scratch data of a single run of a generator or
+ * solver. Memory is carved out of large blocks obtained from the heap, so
+ * the many small allocations made by node based containers cost a pointer
+ * bump rather than a trip through the heap, and everything is freed in one
+ * shot when the arena is destroyed at the end of the run.
+ *
+ * Small blocks handed back to the arena are kept on a free list for their
+ * size and reused, so containers that insert and erase continually (the
+ * frontier of a generator, the stack of a solver) do not grow the arena
+ * without bound. Larger blocks are only reclaimed when the arena goes.
+ *
+ * An arena is not thread safe.
+ **/
+class arena {
+  /// the size of the first block taken from the heap
+  static const std::size_t FIRST_BLOCK = 64 * 1024;
+  /// no block taken from the heap for small allocations is larger than this
+  static const std::size_t MAX_BLOCK = 64 * 1024 * 1024;
+  /// every allocation is rounded up to a multiple of this
+  static const std::size_t GRANULE = 16;
+  /// allocations up to this size are recycled when they are freed
+  static const std::size_t MAX_RECYCLED = 1024;
+
+  /// the blocks taken from the heap
+  std::vector<std::unique_ptr<char[]>> _blocks;
+  /// the next free byte of the current block
+  char* _next;
+  /// the end of the current block
+  char* _end;
+  /// the size of the next block to take from the heap
+  std::size_t _block_size;
+  /// the heads of the free lists of recycled allocations, one for each
+  /// multiple of @ref GRANULE up to @ref MAX_RECYCLED
+  void* _free[MAX_RECYCLED / GRANULE];
+
+  /// the number of allocations served
+  std::size_t _allocations;
+  /// the number of allocations served from a free list
+  std::size_t _recycled;
+  /// the number of bytes taken from the heap
+  std::size_t _reserved;
+
+  /**
+   * takes a new block from the heap and serves an allocation of the
+   * number of bytes specified from it
+   **/
+  void* grow(std::size_t bytes);
+
+ public:
+  /**
+   * constructs an empty arena - nothing is taken from the heap until the
+   * first allocation
+   **/
+  arena(void);
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  /**
+   * @return memory for the number of bytes specified, aligned for any
+   * type
+   **/
+  void* allocate(std::size_t bytes) {
+    bytes = (bytes + GRANULE - 1) & ~(GRANULE - 1);
+    ++_allocations;
+    if (bytes <= MAX_RECYCLED && bytes) {
+      void*& head = _free[bytes / GRANULE - 1];
+      if (head) {
+        void* p = head;
+        head = *static_cast<void**>(p);
+        ++_recycled;
+        return p;
+      }
+    }
+    if (std::size_t(_end - _next) < bytes) return grow(bytes);
+    void* p = _next;
+    _next += bytes;
+    return p;
+  }
+
+  /**
+   * hands back memory obtained from @ref allocate. Small allocations are
+   * kept for reuse; anything else is held until the arena is destroyed.
+   **/
+  void deallocate(void* p, std::size_t bytes) {
+    bytes = (bytes + GRANULE - 1) & ~(GRANULE - 1);
+    if (!p || !bytes || bytes > MAX_RECYCLED) return;
+    void*& head = _free[bytes / GRANULE - 1];
+    *static_cast<void**>(p) = head;
+    head = p;
+  }
+
+  /// @return the number of allocations served by this arena
+  std::size_t allocations(void) const { return _allocations; }
+
+  /// @return the number of allocations served by reusing freed memory
+  std::size_t recycled(void) const { return _recycled; }
+
+  /// @return the number of blocks this arena has taken from the heap
+  std::size_t blocks(void) const { return _blocks.size(); }
+
+  /// @return the number of bytes this arena has taken from the heap
+  std::size_t reserved(void) const { return _reserved; }
+
+  /**
+   * writes a one line summary of the arena's allocations to a stream
+   **/
+  void report(std::ostream&, const char* what) const;
+};
+
+/**
+ * a standard allocator that draws from an @ref arena so that standard
+ * containers can be used for scratch data. An allocator without an arena
+ * uses the heap, so containers can be declared the same way whether or not
+ * an arena is available.
+ **/
+template <class T>
+class arena_allocator {
+  template <class U>
+  friend class arena_allocator;
+
+  /// the arena to allocate from, or nullptr for the heap
+  arena* _arena;
+
+ public:
+  typedef T value_type;
+
+  /**
+   * an allocator that uses the heap
+   **/
+  arena_allocator(void) : _arena(nullptr) {}
+
+  /**
+   * an allocator that draws from the arena specified
+   **/
+  arena_allocator(arena& a) : _arena(&a) {}
+
+  /**
+   * rebinding copy - containers allocate their nodes with a copy of the
+   * allocator they were given
+   **/
+  template <class U>
+  arena_allocator(const arena_allocator<U>& other) : _arena(other._arena) {}
+
+  T* allocate(std::size_t n) {
+    if (!_arena) return static_cast<T*>(::operator new(n * sizeof(T)));
+    return static_cast<T*>(_arena->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    if (!_arena) {
+      ::operator delete(p);
+      return;
+    }
+    _arena->deallocate(p, n * sizeof(T));
+  }
+
+  template <class U>
+  bool operator==(const arena_allocator<U>& other) const {
+    return _arena == other._arena;
+  }
+
+  template <class U>
+  bool operator!=(const arena_allocator<U>& other) const {
+    return _arena != other._arena;
+  }
+};
+
+/**
+ * a vector whose elements live in an @ref arena
+ **/
+template <class T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+}  // namespace data
+}  // namespace mazer2018
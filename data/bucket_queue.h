@@ -0,0 +1,93 @@
+#include <cstddef>
+#include <vector>
+#include "arena.h"
+
+#pragma once
+/**
+ * @file bucket_queue.h defines the priority queue that searches with small
+ * whole number priorities hold their open cells in.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * a priority queue for small whole number priorities that only ever move
+ * forwards - Dial's bucket queue. Each priority has a bucket of its own,
+ * and as no element is ever pushed below the lowest priority still queued
+ * or at or past that priority plus the span the queue was made with, only
+ * span buckets are needed, used round and round. Pushing is an append to
+ * a bucket and popping takes from the lowest bucket that isn't empty, so
+ * both are O(1) rather than the O(log n) of a binary heap.
+ *
+ * Each bucket is a stack, so among the elements of the lowest priority
+ * the one pushed last comes out first.
+ **/
+template <class T>
+class bucket_queue {
+  /// the elements of each priority, priority p in bucket p & @ref _mask
+  std::vector<arena_vector<T>> _buckets;
+  /// selects the bucket of a priority - the number of buckets less one
+  std::size_t _mask;
+  /// no element in the queue has a lower priority than this
+  std::size_t _lowest;
+  /// the number of elements in the queue
+  std::size_t _size;
+
+ public:
+  /**
+   * constructs an empty queue whose elements live in an arena
+   * @param span one more than the furthest above the lowest priority in
+   * the queue that an element is ever pushed
+   **/
+  bucket_queue(arena& a, std::size_t span) : _lowest(0), _size(0) {
+    std::size_t buckets = 1;
+    while (buckets < span) buckets <<= 1;
+    _buckets.assign(buckets, arena_vector<T>(arena_allocator<T>(a)));
+    _mask = buckets - 1;
+  }
+
+  /**
+   * @return whether the queue has no elements
+   **/
+  bool empty(void) const { return _size == 0; }
+
+  /**
+   * @return the number of elements in the queue
+   **/
+  std::size_t size(void) const { return _size; }
+
+  /**
+   * removes every element, keeping the buckets
+   * @param lowest the lowest priority that will be pushed next
+   **/
+  void clear(std::size_t lowest) {
+    for (arena_vector<T>& bucket : _buckets) bucket.clear();
+    _lowest = lowest;
+    _size = 0;
+  }
+
+  /**
+   * adds an element. The priority must be from the lowest priority in the
+   * queue to less than that plus the span.
+   **/
+  void push(std::size_t priority, T value) {
+    _buckets[priority & _mask].push_back(value);
+    ++_size;
+  }
+
+  /**
+   * removes and returns an element of the lowest priority. The queue must
+   * not be empty.
+   * @param priority set to the priority of the element
+   **/
+  T pop(std::size_t& priority) {
+    while (_buckets[_lowest & _mask].empty()) ++_lowest;
+    arena_vector<T>& bucket = _buckets[_lowest & _mask];
+    T value = bucket.back();
+    bucket.pop_back();
+    --_size;
+    priority = _lowest;
+    return value;
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
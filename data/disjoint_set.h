@@ -0,0 +1,188 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "types.h"
+
+#pragma once
+/**
+ * @file disjoint_set.h defines the union-find structures generators use to
+ * track which parts of a maze are already joined.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * a disjoint set forest over the elements 0 to size - 1, held in flat
+ * arrays. Finding a set halves the path to its root as it goes and sets
+ * are joined by rank, so any sequence of operations costs close to O(1)
+ * each.
+ **/
+class disjoint_set {
+  /// the parent of each element - a root is its own parent
+  std::vector<cell_id> _parent;
+  /// an upper bound on the height of the tree under each root
+  std::vector<std::uint8_t> _rank;
+
+ public:
+  /**
+   * constructs a set of the size specified with every element in a set of
+   * its own
+   **/
+  explicit disjoint_set(std::size_t size = 0) { reset(size); }
+
+  /**
+   * resizes the set and puts every element back in a set of its own
+   **/
+  void reset(std::size_t size) {
+    _parent.resize(size);
+    for (std::size_t i = 0; i < size; ++i) _parent[i] = cell_id(i);
+    _rank.assign(size, 0);
+  }
+
+  /// @return the number of elements
+  std::size_t size(void) const { return _parent.size(); }
+
+  /**
+   * @return the root of the set holding an element
+   **/
+  cell_id find(cell_id id) {
+    while (_parent[id] != id) {
+      _parent[id] = _parent[_parent[id]];
+      id = _parent[id];
+    }
+    return id;
+  }
+
+  /**
+   * joins the sets holding two elements
+   * @return false if they were already in the same set
+   **/
+  bool unite(cell_id a, cell_id b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (_rank[a] < _rank[b]) std::swap(a, b);
+    _parent[b] = a;
+    if (_rank[a] == _rank[b]) ++_rank[a];
+    return true;
+  }
+};
+
+/**
+ * a disjoint set forest like @ref disjoint_set that any number of threads
+ * may use at once without locks. Each element is a single atomic word
+ * holding its parent in the low 56 bits and its rank in the top 8, so a
+ * root is linked under another with one compare and swap that fails if
+ * the root has changed in the meantime, in which case the operation
+ * starts again. Path halving is also done with a compare and swap; losing
+ * that race only means the path stays a little longer.
+ **/
+class concurrent_disjoint_set {
+  /// the number of bits of an element that hold its parent
+  static const int PARENT_BITS = 56;
+  /// selects the parent of an element
+  static const std::uint64_t PARENT_MASK =
+      (std::uint64_t(1) << PARENT_BITS) - 1;
+
+  /// the parent and rank of each element
+  std::unique_ptr<std::atomic<std::uint64_t>[]> _nodes;
+  /// the number of elements
+  std::size_t _size;
+
+  static cell_id parent(std::uint64_t node) {
+    return cell_id(node & PARENT_MASK);
+  }
+  static unsigned rank(std::uint64_t node) {
+    return unsigned(node >> PARENT_BITS);
+  }
+  static std::uint64_t make(cell_id parent, unsigned rank) {
+    return std::uint64_t(parent) | (std::uint64_t(rank) << PARENT_BITS);
+  }
+
+ public:
+  /**
+   * constructs a set of the size specified with every element in a set of
+   * its own
+   **/
+  explicit concurrent_disjoint_set(std::size_t size)
+      : _nodes(new std::atomic<std::uint64_t>[size]), _size(size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      _nodes[i].store(make(cell_id(i), 0), std::memory_order_relaxed);
+    }
+  }
+
+  /// @return the number of elements
+  std::size_t size(void) const { return _size; }
+
+  /**
+   * @return the root of the set holding an element. If other threads are
+   * joining sets at the same time it was the root at some point during
+   * the call.
+   **/
+  cell_id find(cell_id id) {
+    for (;;) {
+      std::uint64_t node = _nodes[id].load(std::memory_order_acquire);
+      cell_id up = parent(node);
+      if (up == id) return id;
+      cell_id grand = parent(_nodes[up].load(std::memory_order_acquire));
+      if (grand != up) {
+        _nodes[id].compare_exchange_weak(node, make(grand, rank(node)),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed);
+      }
+      id = grand;
+    }
+  }
+
+  /**
+   * @return whether two elements are in the same set
+   **/
+  bool same(cell_id a, cell_id b) {
+    for (;;) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return true;
+      // a was a root after b was found, so the sets really were apart
+      if (parent(_nodes[a].load(std::memory_order_acquire)) == a) {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * joins the sets holding two elements
+   * @return false if they were already in the same set
+   **/
+  bool unite(cell_id a, cell_id b) {
+    for (;;) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return false;
+      std::uint64_t node_a = _nodes[a].load(std::memory_order_acquire),
+                    node_b = _nodes[b].load(std::memory_order_acquire);
+      if (parent(node_a) != a || parent(node_b) != b) continue;
+      // the lower ranked root goes under the other, with ties broken by
+      // index so that two threads never link a pair both ways
+      if (rank(node_a) < rank(node_b) ||
+          (rank(node_a) == rank(node_b) && a < b)) {
+        std::swap(a, b);
+        std::swap(node_a, node_b);
+      }
+      if (!_nodes[b].compare_exchange_strong(node_b, make(a, rank(node_b)),
+                                             std::memory_order_acq_rel)) {
+        continue;
+      }
+      // the rank is only a hint so it doesn't matter if this fails
+      if (rank(node_a) == rank(node_b)) {
+        _nodes[a].compare_exchange_strong(node_a,
+                                          make(a, rank(node_a) + 1),
+                                          std::memory_order_acq_rel);
+      }
+      return true;
+    }
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
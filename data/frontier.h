@@ -0,0 +1,119 @@
+#include <cstddef>
+#include <vector>
+#include "arena.h"
+
+#pragma once
+/**
+ * @file frontier.h defines the container that holds the cells a growing
+ * tree generator can still grow from.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * the frontier of a growing tree generator - the cells that may still have
+ * unvisited neighbours. The elements are held densely in a vector and are
+ * addressed by their position in it, so adding an element, picking one by
+ * position and removing it are all O(1) whatever the size of the frontier.
+ *
+ * An element is removed by moving the last element into its place (swap
+ * and pop) or, where the order of the newest elements matters, the first
+ * element - unless it is the last element itself, which is just dropped.
+ * The generator always knows the position of the element it picked, so
+ * that position is the only index needed and no per cell lookup table has
+ * to be kept. Removing the last element keeps the order of the rest, so a
+ * frontier only ever picked from the back behaves as a stack; one only
+ * ever picked from the front behaves as a queue.
+ **/
+template <class T>
+class frontier {
+  /// the elements of the frontier, oldest first. Elements before
+  /// @ref _head have been removed from the front.
+  arena_vector<T> _items;
+  /// the position in @ref _items of the first element
+  std::size_t _head;
+
+  /// the front is only compacted once this many elements have gone
+  static const std::size_t MIN_COMPACT = 1024;
+
+ public:
+  /**
+   * constructs an empty frontier that uses the heap
+   **/
+  frontier(void) : _head(0) {}
+
+  /**
+   * constructs an empty frontier whose elements live in an arena
+   **/
+  explicit frontier(arena& a) : _items(a), _head(0) {}
+
+  /**
+   * adds an element at the back of the frontier
+   **/
+  void push(T value) { _items.push_back(value); }
+
+  /**
+   * @return the element at a position
+   **/
+  T operator[](std::size_t pos) const { return _items[_head + pos]; }
+
+  /**
+   * @return the most recently added element that is still in the frontier
+   * when only the back has been removed from
+   **/
+  T back(void) const { return _items.back(); }
+
+  /**
+   * removes the element at a position by moving the last element into
+   * its place
+   **/
+  void remove(std::size_t pos) {
+    _items[_head + pos] = _items.back();
+    _items.pop_back();
+  }
+
+  /**
+   * removes the oldest element. The space it held is reclaimed once at
+   * least half of the vector has been removed this way, so the cost is
+   * O(1) amortized.
+   **/
+  void pop_front(void) {
+    if (++_head == _items.size()) {
+      clear();
+    } else if (_head >= MIN_COMPACT && 2 * _head >= _items.size()) {
+      _items.erase(_items.begin(), _items.begin() + _head);
+      _head = 0;
+    }
+  }
+
+  /**
+   * removes the element at a position by moving the oldest element into
+   * its place, so the elements newer than it keep their order. The newest
+   * element is simply dropped, as moving the oldest into its place would
+   * make that the newest.
+   **/
+  void remove_front_fill(std::size_t pos) {
+    if (pos + 1 == size()) {
+      _items.pop_back();
+      if (empty()) clear();
+      return;
+    }
+    _items[_head + pos] = _items[_head];
+    pop_front();
+  }
+
+  /**
+   * removes every element, keeping the memory for reuse
+   **/
+  void clear(void) {
+    _items.clear();
+    _head = 0;
+  }
+
+  /// @return the number of elements in the frontier
+  std::size_t size(void) const { return _items.size() - _head; }
+
+  /// @return whether the frontier is empty
+  bool empty(void) const { return _items.size() == _head; }
+};
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,34 @@
+#include "layout.h"
+
+/**
+ * @param type the order to store the cells in
+ * @param width the width of the maze in cells
+ * @param height the height of the maze in cells
+ **/
+mazer2018::data::cell_layout::cell_layout(layout_type type, int width,
+                                          int height)
+    : _type(type), _width(width), _height(height) {
+  switch (type) {
+    case layout_type::ROW_MAJOR:
+      _shift = 0;
+      break;
+    case layout_type::TILED_8:
+      _shift = 3;
+      break;
+    default:
+      _shift = 6;
+      break;
+  }
+  if (type == layout_type::ROW_MAJOR) {
+    _tiles_x = 1;
+    _row_stride = width;
+    _capacity = cell_id(width) * height;
+    return;
+  }
+  // pad the maze out to a whole number of tiles in each direction
+  const int side = 1 << _shift;
+  _tiles_x = (width + side - 1) >> _shift;
+  cell_id tiles_y = (height + side - 1) >> _shift;
+  _row_stride = _tiles_x << (2 * _shift);
+  _capacity = _row_stride * tiles_y;
+}
@@ -0,0 +1,212 @@
+#include "types.h"
+
+#pragma once
+/**
+ * @file layout.h defines how the cells of a maze are ordered in memory.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * the order in which the cells of a maze are stored. Algorithms that move
+ * in both x and y touch a new cache line (and eventually a new page) on
+ * every vertical step when the cells are stored row by row. The tiled and
+ * morton layouts keep cells that are close in both dimensions close in
+ * memory.
+ **/
+enum class layout_type {
+  /// one row after another - handle y * width + x
+  ROW_MAJOR,
+  /// 8x8 tiles stored row by row, each tile row-major within itself
+  TILED_8,
+  /// 64x64 tiles stored row by row, each tile row-major within itself
+  TILED_64,
+  /// 64x64 tiles stored row by row, each tile in z-order (morton order)
+  MORTON
+};
+
+/**
+ * maps between cell coordinates and cell handles for a particular
+ * @ref layout_type. The tiled layouts pad the maze out to a whole number
+ * of tiles so there may be more handles than cells - see @ref capacity.
+ * Handles of padding cells are never returned by @ref index.
+ *
+ * @ref neighbour never needs a division. When a step leaves the maze on
+ * the north or west side of the very first row or tile the handle
+ * returned is negative; other steps off the maze land on a cell on the
+ * far side or in the padding, and those cells never have a passage
+ * leading back.
+ **/
+class cell_layout {
+  /// the layout being used
+  layout_type _type;
+  /// the width of the maze in cells
+  int _width,
+      /// the height of the maze in cells
+      _height;
+  /// log2 of the width / height of a tile. 0 for row-major.
+  int _shift;
+  /// the number of tiles in each row of tiles
+  cell_id _tiles_x;
+  /// the number of handles in each row of tiles (or row of cells for
+  /// row-major)
+  cell_id _row_stride;
+  /// the total number of handles
+  cell_id _capacity;
+
+  /// the bits of a morton code within a tile that hold the x coordinate
+  static const cell_id XMASK = 0x555;
+  /// the bits of a morton code within a tile that hold the y coordinate
+  static const cell_id YMASK = 0xAAA;
+
+  /**
+   * spreads the low 6 bits of v out so that they occupy the even bits
+   **/
+  static cell_id dilate(cell_id v) {
+    v &= 0x3f;
+    v = (v | (v << 4)) & 0x30f;
+    v = (v | (v << 2)) & 0x333;
+    v = (v | (v << 1)) & 0x555;
+    return v;
+  }
+
+  /**
+   * the reverse of @ref dilate - gathers the even bits of v together
+   **/
+  static int compact(cell_id v) {
+    v &= 0x555;
+    v = (v | (v >> 1)) & 0x333;
+    v = (v | (v >> 2)) & 0x30f;
+    v = (v | (v >> 4)) & 0x3f;
+    return int(v);
+  }
+
+ public:
+  /**
+   * default constructor - a row-major layout of an empty maze
+   **/
+  cell_layout(void) : cell_layout(layout_type::ROW_MAJOR, 0, 0) {}
+
+  /**
+   * constructs the layout of a maze of the specified size
+   **/
+  cell_layout(layout_type type, int width, int height);
+
+  /// @return the layout being used
+  layout_type type(void) const { return _type; }
+
+  /**
+   * @return the number of handles needed to hold the maze including any
+   * padding. Valid handles are 0 to capacity() - 1.
+   **/
+  cell_id capacity(void) const { return _capacity; }
+
+  /**
+   * @return the width of the maze including any padding columns
+   **/
+  int padded_width(void) const {
+    if (_type == layout_type::ROW_MAJOR) return _width;
+    return int(_tiles_x << _shift);
+  }
+
+  /**
+   * @return the height of the maze including any padding rows
+   **/
+  int padded_height(void) const {
+    if (_type == layout_type::ROW_MAJOR) return _height;
+    return _tiles_x ? int(_capacity / padded_width()) : 0;
+  }
+
+  /**
+   * @return the handle of the cell at x, y
+   **/
+  cell_id index(int x, int y) const {
+    if (_type == layout_type::ROW_MAJOR) return cell_id(y) * _width + x;
+    const int mask = (1 << _shift) - 1;
+    cell_id tile = cell_id(y >> _shift) * _row_stride +
+                   (cell_id(x >> _shift) << (2 * _shift));
+    if (_type == layout_type::MORTON) {
+      return tile | dilate(x & mask) | (dilate(y & mask) << 1);
+    }
+    return tile | (cell_id(y & mask) << _shift) | (x & mask);
+  }
+
+  /**
+   * @return the x coordinate of a cell
+   **/
+  int x_of(cell_id id) const {
+    if (_type == layout_type::ROW_MAJOR) return int(id % _width);
+    const int mask = (1 << _shift) - 1;
+    int tile_x = int((id >> (2 * _shift)) % _tiles_x) << _shift;
+    if (_type == layout_type::MORTON) return tile_x | compact(id);
+    return tile_x | int(id & mask);
+  }
+
+  /**
+   * @return the y coordinate of a cell
+   **/
+  int y_of(cell_id id) const {
+    if (_type == layout_type::ROW_MAJOR) return int(id / _width);
+    const int mask = (1 << _shift) - 1;
+    int tile_y = int((id >> (2 * _shift)) / _tiles_x) << _shift;
+    if (_type == layout_type::MORTON) return tile_y | compact(id >> 1);
+    return tile_y | int((id >> _shift) & mask);
+  }
+
+  /**
+   * @return the handle of the cell one step from a cell in the direction
+   * specified. See the class description for steps off the maze.
+   **/
+  cell_id neighbour(cell_id id, direction dir) const {
+    const cell_id last = (cell_id(1) << _shift) - 1;
+    const cell_id tile = cell_id(1) << (2 * _shift);
+    switch (_type) {
+      case layout_type::ROW_MAJOR:
+        switch (dir) {
+          case direction::NORTH:
+            return id - _width;
+          case direction::SOUTH:
+            return id + _width;
+          case direction::EAST:
+            return id + 1;
+          default:
+            return id - 1;
+        }
+      case layout_type::MORTON:
+        switch (dir) {
+          case direction::NORTH:
+            if (id & YMASK)
+              return (((id & YMASK) - 1) & YMASK) | (id & ~YMASK);
+            return (id | YMASK) - _row_stride;
+          case direction::SOUTH:
+            if ((id & YMASK) != YMASK)
+              return (((id | XMASK) + 1) & YMASK) | (id & ~YMASK);
+            return (id & ~YMASK) + _row_stride;
+          case direction::EAST:
+            if ((id & XMASK) != XMASK)
+              return (((id | YMASK) + 1) & XMASK) | (id & ~XMASK);
+            return (id & ~XMASK) + tile;
+          default:
+            if (id & XMASK)
+              return (((id & XMASK) - 1) & XMASK) | (id & ~XMASK);
+            return (id | XMASK) - tile;
+        }
+      default:
+        switch (dir) {
+          case direction::NORTH:
+            if ((id >> _shift) & last) return id - (last + 1);
+            return id - _row_stride + last * (last + 1);
+          case direction::SOUTH:
+            if (((id >> _shift) & last) != last) return id + (last + 1);
+            return id + _row_stride - last * (last + 1);
+          case direction::EAST:
+            if ((id & last) != last) return id + 1;
+            return id + tile - last;
+          default:
+            if (id & last) return id - 1;
+            return id - tile + last;
+        }
+    }
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
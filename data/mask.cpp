@@ -0,0 +1,97 @@
+#include "mask.h"
+#include <cctype>
+#include <iostream>
+
+mazer2018::data::cell_id mazer2018::data::cell_mask::first(void) const {
+  cell_id best = constants::ERROR;
+  for_each([&](cell_id id) {
+    if (best == constants::ERROR || id < best) best = id;
+  });
+  return best;
+}
+
+mazer2018::data::cell_id mazer2018::data::cell_mask::last(void) const {
+  cell_id best = constants::ERROR;
+  for_each([&](cell_id id) {
+    if (id > best) best = id;
+  });
+  return best;
+}
+
+int mazer2018::data::pbm_reader::read_number(void) {
+  int ch = _in.get();
+  // skip whitespace and comments, which run to the end of the line
+  while (ch != EOF && (std::isspace(ch) || ch == '#')) {
+    if (ch == '#') {
+      while (ch != EOF && ch != '\n') ch = _in.get();
+    }
+    ch = _in.get();
+  }
+  if (ch == EOF || !std::isdigit(ch)) return constants::ERROR;
+  long value = 0;
+  while (ch != EOF && std::isdigit(ch)) {
+    value = value * 10 + (ch - '0');
+    if (value > constants::MAX_DIM) return constants::ERROR;
+    ch = _in.get();
+  }
+  // a single whitespace character ends the header of a raw file, so the
+  // character after the last number is consumed here
+  return int(value);
+}
+
+/**
+ * @param name the name of the bitmap file
+ **/
+bool mazer2018::data::pbm_reader::open(const std::string& name) {
+  _in.open(name, std::ios::binary);
+  if (!_in) {
+    std::cerr << "Error: could not open the mask file " << name << std::endl;
+    return false;
+  }
+  char magic[2] = {0, 0};
+  _in.read(magic, sizeof(magic));
+  if (!_in || magic[0] != 'P' || (magic[1] != '1' && magic[1] != '4')) {
+    std::cerr << "Error: " << name << " is not a pbm file." << std::endl;
+    return false;
+  }
+  _raw = magic[1] == '4';
+  _width = read_number();
+  _height = read_number();
+  if (_width <= 0 || _height <= 0) {
+    std::cerr << "Error: " << name << " does not have a valid size."
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @param row the vector to fill with 1 for each pixel in the mask and 0
+ * for each pixel outside it
+ **/
+bool mazer2018::data::pbm_reader::read_row(std::vector<std::uint8_t>& row) {
+  row.resize(std::size_t(_width));
+  if (_raw) {
+    // eight pixels to a byte, most significant bit first, and each row
+    // starts on a new byte
+    std::vector<char> bytes(std::size_t((_width + 7) / 8));
+    _in.read(bytes.data(), std::streamsize(bytes.size()));
+    if (!_in) return false;
+    for (int x = 0; x < _width; ++x) {
+      row[x] = (std::uint8_t(bytes[x >> 3]) >> (7 - (x & 7))) & 1;
+    }
+    return true;
+  }
+  for (int x = 0; x < _width; ++x) {
+    int ch = _in.get();
+    while (ch != EOF && (std::isspace(ch) || ch == '#')) {
+      if (ch == '#') {
+        while (ch != EOF && ch != '\n') ch = _in.get();
+      }
+      ch = _in.get();
+    }
+    if (ch != '0' && ch != '1') return false;
+    row[x] = std::uint8_t(ch - '0');
+  }
+  return true;
+}
@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../constants/constants.h"
+#include "sparse_array.h"
+#include "types.h"
+
+#pragma once
+/**
+ * @file mask.h defines the mask that cuts a maze out of an irregular shape
+ * and the reader for the bitmap files masks are loaded from.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * the set of cells of a maze that are in use. Cells outside the mask are
+ * never joined to anything, so a maze generated over a mask fills only the
+ * shape the mask describes.
+ *
+ * The mask holds one bit per cell, indexed by cell handle, in a
+ * @ref sparse_array so that a small shape inside a huge bounding box only
+ * costs memory for the tiles it touches.
+ **/
+class cell_mask {
+  /// the width of the maze the mask was made for
+  int _width,
+      /// the height of the maze the mask was made for
+      _height;
+  /// one bit per cell handle - 4096 cells to a chunk
+  sparse_array<std::uint64_t, 6> _bits;
+  /// the number of cells in the mask
+  cell_id _count;
+
+ public:
+  /**
+   * constructs an empty mask for a maze of the size specified
+   **/
+  cell_mask(int width, int height)
+      : _width(width), _height(height), _count(0) {}
+
+  /// @return the width of the maze the mask was made for
+  int width(void) const { return _width; }
+
+  /// @return the height of the maze the mask was made for
+  int height(void) const { return _height; }
+
+  /// @return the number of cells in the mask
+  cell_id count(void) const { return _count; }
+
+  /**
+   * @return whether a cell is in the mask
+   **/
+  bool test(cell_id id) const {
+    return (_bits.get(std::size_t(id) >> 6) >> (id & 63)) & 1;
+  }
+
+  /**
+   * adds a cell to the mask
+   **/
+  void set(cell_id id) {
+    std::uint64_t& word = _bits.touch(std::size_t(id) >> 6);
+    std::uint64_t bit = std::uint64_t(1) << (id & 63);
+    if (!(word & bit)) {
+      word |= bit;
+      ++_count;
+    }
+  }
+
+  /**
+   * @return the smallest handle in the mask or @ref constants::ERROR if
+   * the mask is empty
+   **/
+  cell_id first(void) const;
+
+  /**
+   * @return the largest handle in the mask or @ref constants::ERROR if the
+   * mask is empty
+   **/
+  cell_id last(void) const;
+
+  /**
+   * calls f(id) for every cell in the mask, in no particular order
+   **/
+  template <class F>
+  void for_each(F f) const {
+    _bits.for_each_chunk([&](std::size_t key, const std::uint64_t* chunk) {
+      for (std::size_t i = 0; i < _bits.CHUNK; ++i) {
+        for (std::uint64_t word = chunk[i]; word; word &= word - 1) {
+          int b = 0;
+          while (!((word >> b) & 1)) ++b;
+          f(cell_id(((key * _bits.CHUNK + i) << 6) + b));
+        }
+      }
+    });
+  }
+};
+
+/**
+ * reads a portable bitmap (pbm) file a row at a time, so that a huge mask
+ * never has to be held in memory as a bitmap. Both the plain (P1) and raw
+ * (P4) forms are understood. A 1 (black) pixel is a cell in the mask.
+ **/
+class pbm_reader {
+  /// the file being read
+  std::ifstream _in;
+  /// whether the file is the raw (P4) form
+  bool _raw;
+  /// the width of the bitmap
+  int _width,
+      /// the height of the bitmap
+      _height;
+
+  /**
+   * reads the next number from the header, skipping whitespace and
+   * comments
+   * @return the number or @ref constants::ERROR
+   **/
+  int read_number(void);
+
+ public:
+  pbm_reader(void) : _raw(false), _width(0), _height(0) {}
+
+  /**
+   * opens a bitmap file and reads its header
+   * @return false if the file can't be opened or is not a pbm file, in
+   * which case the reason has been written to std::cerr
+   **/
+  bool open(const std::string&);
+
+  /// @return the width of the bitmap
+  int width(void) const { return _width; }
+
+  /// @return the height of the bitmap
+  int height(void) const { return _height; }
+
+  /**
+   * reads the next row of the bitmap into row, one element per pixel
+   * @return false if the file is truncated or corrupt
+   **/
+  bool read_row(std::vector<std::uint8_t>& row);
+};
+}  // namespace data
+}  // namespace mazer2018
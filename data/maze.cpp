@@ -1,7 +1,118 @@
 #include "maze.h"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include "../args/action.h"
+
+mazer2018::data::maze::~maze(void) { sync(); }
 
 void mazer2018::data::maze::init(void) { _initialized = true; }
 
+/**
+ * @param type the layout to store the cells in from now on
+ **/
+void mazer2018::data::maze::layout(layout_type type) {
+  if (type == _layout.type()) return;
+  // take a copy of the passages so the grid keeps its storage - a maze
+  // mapped onto a file stays in that file
+  cell_layout old_layout = _layout;
+  wall_grid old_grid;
+  old_grid.sparse(_grid.sparse());
+  old_grid.assign(_grid);
+  _layout = cell_layout(type, _width, _height);
+  _grid.resize(std::size_t(capacity()));
+  write_header();
+  // copy the passages of each cell to its new position
+  auto move_cell = [&](int x, int y) {
+    cell_id from = old_layout.index(x, y), to = index(x, y);
+    _grid.set_east(to, old_grid.east(from));
+    _grid.set_south(to, old_grid.south(from));
+  };
+  if (_mask) {
+    // only cells in the mask can have passages, and the mask itself is
+    // indexed by handle so it moves too
+    std::unique_ptr<cell_mask> old_mask = std::move(_mask);
+    _mask.reset(new cell_mask(_width, _height));
+    old_mask->for_each([&](cell_id id) {
+      int x = old_layout.x_of(id), y = old_layout.y_of(id);
+      _mask->set(index(x, y));
+      move_cell(x, y);
+    });
+    return;
+  }
+  for (int y = 0; y < _height; ++y) {
+    for (int x = 0; x < _width; ++x) {
+      move_cell(x, y);
+    }
+  }
+}
+
+void mazer2018::data::maze::resize(void) {
+  _layout = cell_layout(_layout.type(), _width, _height);
+  if (_mask && (_mask->width() != _width || _mask->height() != _height)) {
+    _mask.reset();
+  }
+  // a masked maze only holds memory for the parts of the grid in use
+  if (_grid.sparse() != masked()) _grid.sparse(masked());
+  _grid.resize(std::size_t(capacity()));
+  write_header();
+  _solution.clear();
+}
+
+/**
+ * @param name the name of the maze file to create
+ **/
+void mazer2018::data::maze::map_file(const std::string& name) {
+  // the passages we already have are copied into the file
+  std::int64_t edges = edge_count();
+  _grid.storage(mapped_storage::create(name));
+  write_header();
+  _grid.storage().header()->edges = std::uint64_t(edges);
+}
+
+/**
+ * @param width the width of the maze
+ * @param height the height of the maze
+ * @param source works out the passages of each tile
+ * @param tiles the most tiles to hold at once
+ **/
+void mazer2018::data::maze::procedural(int width, int height,
+                                       std::unique_ptr<tile_source> source,
+                                       std::size_t tiles) {
+  // bring a file this maze was mapped onto up to date before leaving it
+  sync();
+  _mask.reset();
+  _width = width;
+  _height = height;
+  // a tile of the source is a chunk of 64x64 cells in this layout
+  _layout = cell_layout(layout_type::TILED_64, width, height);
+  const std::size_t cells = std::size_t(capacity());
+  const std::size_t words =
+      2 * ((cells + wall_grid::BLOCK_BITS - 1) >> wall_grid::BLOCK_SHIFT);
+  _grid.attach(std::unique_ptr<grid_storage>(
+                   new tile_storage(std::move(source), words, tiles)),
+               cells);
+  _solution.clear();
+  init();
+}
+
+void mazer2018::data::maze::write_header(void) {
+  binary_header* header = _grid.storage().header();
+  if (!header || _grid.storage().read_only()) return;
+  header->width = std::uint64_t(_width);
+  header->height = std::uint64_t(_height);
+  header->layout = std::uint32_t(_layout.type());
+  header->edges = 0;
+}
+
+void mazer2018::data::maze::sync(void) {
+  binary_header* header = _grid.storage().header();
+  if (!header || _grid.storage().read_only()) return;
+  header->edges = std::uint64_t(edge_count());
+  _grid.storage().flush();
+}
+
 /**
  * @param dir the direction we wish to reverse
  * @return the reverse direction to the one passed in
@@ -36,57 +147,46 @@ const mazer2018::data::direction mazer2018::data::operator!(
  * return true when we successfully save the maze and false if we
  * have any i/o problems along the way.
  **/
-bool mazer2018::data::maze::save_binary(const std::string& name) {
-  int num_edges;
-  int x_count, y_count, e_count;
-
+bool mazer2018::data::maze::save_binary(const std::string& name) const {
+  // a mapped maze may be saved over the file it was loaded from. Writing
+  // to a new file and renaming it over the old one leaves the mapping
+  // with the old file rather than truncating the memory we are reading.
+  const std::string out_name = mapped() ? name + ".tmp" : name;
   // open the file and check that the open was successful
-  std::ofstream out(name, std::ios::binary);
+  std::ofstream out(out_name, std::ios::binary);
   if (!out) {
     std::cerr << "Failed to open file " << name << std::endl;
     return false;
   }
   // enable exception handling on the stream
   out.exceptions(std::ios::badbit | std::ios::failbit);
-  // clear the visited flags so we are starting our edge navigation
-  // from scratch
-  set_unvisited();
-  num_edges = edge_count();
-  int edge_counter = 0;
-  // reset the visited flags as counting the number of edges changes
-  // them
-  set_unvisited();
+  // fill in the header - each passage is held exactly once in the grid so
+  // the number of edges is simply the number of open passages
+  binary_header header = {};
+  std::copy(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC), header.magic);
+  header.version = BINARY_VERSION;
+  header.width = std::uint64_t(_width);
+  header.height = std::uint64_t(_height);
+  header.edges = std::uint64_t(edge_count());
+  header.layout = std::uint32_t(_layout.type());
+  header.words = _grid.num_words();
   try {
-    // write out the width, height and number of edges
-    out.write((char*)&_width, sizeof(int));
-    out.write((char*)&_height, sizeof(int));
-    out.write((char*)&num_edges, sizeof(int));
-
-    // iterate over the cells vector, writing each edge to the
-    // svg file.
-    for (y_count = 0; y_count < _height; ++y_count) {
-      for (x_count = 0; x_count < _width; ++x_count) {
-        cell& c = _cells[y_count][x_count];
-        for (e_count = 0; e_count < num_dirs; ++e_count) {
-          edge& e = c.adjacents[e_count];
-          // if this is a valid edge and has not been visited,
-          // we write it out
-          if (valid_edge(e) && !e.visited) {
-            out.write((char*)&e.in_x, sizeof(int));
-            out.write((char*)&e.in_y, sizeof(int));
-            out.write((char*)&e.out_x, sizeof(int));
-            out.write((char*)&e.out_y, sizeof(int));
-            e.visited = true;
-            if (e.out_y < 0 || e.out_y > int(_height)) continue;
-            if (e.out_x < 0 || e.out_x > int(_width)) continue;
-            ++edge_counter;
-            // grab the reverse edge and also set it
-            // to being visited
-            cell& other = _cells[e.out_y][e.out_x];
-            edge& e = other.adjacents[int(!direction(e_count))];
-            e.visited = true;
-          }
+    // write out the header then the grid itself in one go
+    out.write((const char*)&header, sizeof(header));
+    if (_grid.words()) {
+      out.write((const char*)_grid.words(),
+                std::streamsize(_grid.num_words() * sizeof(std::uint64_t)));
+    } else {
+      // a sparse grid is written a buffer at a time with zeros for the
+      // parts that were never allocated
+      std::vector<std::uint64_t> buffer(sparse_words::CHUNK);
+      for (std::size_t i = 0; i < _grid.num_words(); i += buffer.size()) {
+        std::size_t count = std::min(buffer.size(), _grid.num_words() - i);
+        for (std::size_t j = 0; j < count; ++j) {
+          buffer[j] = _grid.word(i + j);
         }
+        out.write((const char*)buffer.data(),
+                  std::streamsize(count * sizeof(std::uint64_t)));
       }
     }
   } catch (const std::ios_base::failure& f) {
@@ -94,12 +194,9 @@ bool mazer2018::data::maze::save_binary(const std::string& name) {
     std::cerr << f.what() << std::endl;
     return false;
   }
-  // have we written the number of edges we expected to? If we
-  // haven't, display an error message and return false
-  if (num_edges != edge_counter) {
-    std::cerr << "Error: incorrect number of edges written." << std::endl;
-    std::cerr << "Expected: " << num_edges << " Actual: " << edge_counter
-              << std::endl;
+  out.close();
+  if (out_name != name && std::rename(out_name.c_str(), name.c_str()) != 0) {
+    std::cerr << "Failed to replace file " << name << std::endl;
     return false;
   }
   // this is a successful run so return true
@@ -111,10 +208,12 @@ bool mazer2018::data::maze::save_binary(const std::string& name) {
  * @return true if the save was successful and false otherwise
  **/
 bool mazer2018::data::maze::load_binary(const std::string& name) {
-  int num_edges, cur_edges = 0, y_count;
-
+  // finish off the file we may be mapped onto before it is replaced
+  sync();
+  // a loaded maze uses all of its cells
+  _mask.reset();
   // open the file and check that the open is successful
-  std::ifstream in(name);
+  std::ifstream in(name, std::ios::binary);
   if (!in) {
     std::cerr << "oh no - there was an error opening binary file"
               << " for reading." << std::endl;
@@ -122,25 +221,198 @@ bool mazer2018::data::maze::load_binary(const std::string& name) {
   }
   // enable exception handling on the stream
   in.exceptions(std::ios::badbit | std::ios::failbit);
-  // set all the edges in the maze to not visited as we are starting
-  // from scratch
-  set_unvisited();
   try {
+    // a version 2 file starts with a magic number - anything else is a
+    // version 1 file so go back and read it from the start
+    char magic[sizeof(BINARY_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (std::equal(magic, magic + sizeof(magic), BINARY_MAGIC)) {
+      if (mapped_storage::supported()) {
+        in.close();
+        return load_binary_mapped(name);
+      }
+      return load_binary_v2(in);
+    }
+    in.seekg(0);
+  } catch (const std::ios_base::failure& f) {
+    std::cerr << "Error: the binary file is too short to hold a maze."
+              << std::endl;
+    return false;
+  }
+  return load_binary_v1(in);
+}
+
+/**
+ * @param name the name of the pbm file holding the mask
+ * @return true if the mask was loaded and false otherwise
+ **/
+bool mazer2018::data::maze::load_mask(const std::string& name) {
+  pbm_reader pbm;
+  if (!pbm.open(name)) return false;
+  if (!valid_dim(pbm.width()) || !valid_dim(pbm.height())) {
+    std::cerr << "Error: the mask is not a valid size for a maze."
+              << std::endl;
+    return false;
+  }
+  // an empty mask of the right size survives the resize, which makes the
+  // grid sparse. It is filled in once the layout knows the new size.
+  _width = pbm.width();
+  _height = pbm.height();
+  _mask.reset(new cell_mask(_width, _height));
+  resize();
+  std::vector<std::uint8_t> row;
+  for (int y = 0; y < _height; ++y) {
+    if (!pbm.read_row(row)) {
+      std::cerr << "Error: the mask file " << name << " is truncated."
+                << std::endl;
+      _mask.reset();
+      resize();
+      return false;
+    }
+    for (int x = 0; x < _width; ++x) {
+      if (row[x]) _mask->set(index(x, y));
+    }
+  }
+  if (_mask->count() == 0) {
+    std::cerr << "Error: the mask " << name << " has no cells in it."
+              << std::endl;
+    _mask.reset();
+    resize();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @param in the stream to read the grid from, positioned just after the
+ * magic number
+ * @return true if the load was successful and false otherwise
+ **/
+bool mazer2018::data::maze::load_binary_v2(std::ifstream& in) {
+  binary_header header;
+  try {
+    // read the rest of the header
+    in.read((char*)&header + sizeof(BINARY_MAGIC),
+            sizeof(header) - sizeof(BINARY_MAGIC));
+    if (!read_header(header)) return false;
+    // sizing the grid leaves it without passages
+    resize();
+    if (header.words != _grid.num_words()) {
+      std::cerr << "Error: the size of the grid in the binary file does "
+                << "not match its dimensions." << std::endl;
+      return false;
+    }
+    in.read((char*)_grid.words(),
+            std::streamsize(_grid.num_words() * sizeof(std::uint64_t)));
+  } catch (const std::ios_base::failure& f) {
+    std::cerr << "Error: the binary file is truncated." << std::endl;
+    return false;
+  }
+  // validate the grid before we trust it
+  if (std::uint64_t(edge_count()) != header.edges) {
+    std::ostringstream oss;
+    oss << "Error: the number of edges don't match what was "
+        << "specified in the file. " << std::endl;
+    throw args::action_failed(oss.str());
+  }
+  if (!consistent()) {
+    std::cerr << "Error: the binary file has passages that leave the maze."
+              << std::endl;
+    return false;
+  }
+  // set the maze to be initialized so it can be written out if
+  // requested
+  init();
+  return true;
+}
+
+/**
+ * the grid is used where it lies in the file, so only the header, the
+ * size of the file and the border of the grid are checked. The passage
+ * count in the header is trusted rather than counted.
+ * @param name the name of the file to map
+ * @return true if the load was successful and false otherwise
+ **/
+bool mazer2018::data::maze::load_binary_mapped(const std::string& name) {
+  std::unique_ptr<mapped_storage> storage = mapped_storage::open(name);
+  if (!storage) return false;
+  if (!read_header(*storage->header())) return false;
+  if (!_grid.attach(std::move(storage), std::size_t(capacity()))) {
+    std::cerr << "Error: the size of the grid in the binary file does "
+              << "not match its dimensions." << std::endl;
+    // leave an empty maze of the right size rather than a grid that does
+    // not match the layout
+    resize();
+    return false;
+  }
+  _solution.clear();
+  if (!consistent()) {
+    std::cerr << "Error: the binary file has passages that leave the maze."
+              << std::endl;
+    return false;
+  }
+  init();
+  return true;
+}
+
+/**
+ * @param header the header read from the file
+ * @return true if the header describes a maze we can load
+ **/
+bool mazer2018::data::maze::read_header(const binary_header& header) {
+  if (header.version != BINARY_VERSION) {
+    std::cerr << "Error: unsupported binary file version " << header.version
+              << std::endl;
+    return false;
+  }
+  // a streamed maze may be taller than MAX_DIM, so its height is only
+  // held to the cells a maze may have
+  if (header.width > std::uint64_t(constants::MAX_DIM) ||
+      !valid_dim(int(header.width)) ||
+      header.height < std::uint64_t(constants::MIN_DIM) ||
+      header.height > std::uint64_t(std::numeric_limits<int>::max()) ||
+      header.height >
+          std::uint64_t(constants::MAX_CELLS) / header.width) {
+    throw args::action_failed(
+        "invalid dimensions specified for "
+        "the maze in the binary file");
+  }
+  if (header.layout > std::uint32_t(layout_type::MORTON)) {
+    std::cerr << "Error: invalid layout in the binary file" << std::endl;
+    return false;
+  }
+  // the grid is stored in the layout it was saved with so adopt that
+  // layout
+  _width = int(header.width);
+  _height = int(header.height);
+  _layout = cell_layout(layout_type(header.layout), _width, _height);
+  return true;
+}
+
+/**
+ * @param in the stream to read the maze from, positioned at the start of
+ * the file
+ * @return true if the load was successful and false otherwise
+ **/
+bool mazer2018::data::maze::load_binary_v1(std::ifstream& in) {
+  int num_edges = constants::ERROR, cur_edges = 0;
+  try {
+    int w, h;
     // read in the width and height and count of edges
-    in.read((char*)&_width, sizeof(int));
-    in.read((char*)&_height, sizeof(int));
+    in.read((char*)&w, sizeof(int));
+    in.read((char*)&h, sizeof(int));
     // get the number of edges from the file
     in.read((char*)&num_edges, sizeof(int));
-    if (!valid_dim(_width) || !valid_dim(_height)) {
+    if (!valid_dim(w) || !valid_dim(h)) {
       throw args::action_failed(
           "invalid dimensions specified for "
           "the maze in the binary file");
     }
-    // resize the width and height according to the numbers read in
-    _cells.resize(_height);
-    for (y_count = 0; y_count < _height; ++y_count) {
-      _cells[y_count].resize(_width);
-    }
+    // resize the width and height according to the numbers read in. This
+    // also starts us off with a maze that has no passages.
+    _width = w;
+    _height = h;
+    resize();
 
     // set the maze to be initialized so it can be written out if
     // requested
@@ -158,21 +430,13 @@ bool mazer2018::data::maze::load_binary(const std::string& name) {
         std::cerr << "Error: an invalid edge was read." << std::endl;
         return false;
       }
-      // get the direction of this edge (north, south, east or west)
-      // as well as its reverse direction then store this edge as well
-      int in_x = e.in_x, in_y = e.in_y, out_x = e.out_x, out_y = e.out_y;
-      direction dir = get_dir(in_x, in_y, out_x, out_y);
-      if (dir == direction::INVALID) {
+      // open the passage between the two cells - this fails when the
+      // edge is not between two adjacent cells
+      if (!add_edge(e)) {
         std::cerr << "Error: there was an edge in an invalid "
                   << "direction" << std::endl;
         return false;
       }
-      direction rev = !dir;
-      e.visited = false;
-      _cells[in_y][in_x].adjacents[int(dir)] = e;
-      edge other = {out_x, out_y, in_x, in_y};
-      other.visited = false;
-      _cells[out_y][out_x].adjacents[int(rev)] = other;
       // we increment the count of edges for validation
       ++cur_edges;
     }
@@ -216,7 +480,7 @@ bool mazer2018::data::maze::valid_edge(const edge& e) const {
  * @param name the name of the svg file to save
  * @return true when the file is successfully saved and false otherwise
  **/
-bool mazer2018::data::maze::save_svg(const std::string& name) {
+bool mazer2018::data::maze::save_svg(const std::string& name) const {
 
 	return save_svg_func(name);
 
@@ -229,25 +493,19 @@ bool mazer2018::data::maze::save_svg(const std::string& name) {
   if (!out) return false;
   // enable exception handling on the stream
   out.exceptions(std::ios::badbit | std::ios::failbit);
-  // reset the visited status of each edge so we only write each
-  // bidirectional edge once
-  set_unvisited();
-
   try {
     // write the prologue for the svg file and the background
     save_svg_prologue(out, magnification);
     save_svg_background(out, magnification);
-    // iterate over each cell of the maze. If it is a valid edge,
-    // save it and set its visited status as well as setting the
-    // visited status of the opposite edge
+    // iterate over each cell of the maze, saving its south and east
+    // passages so each bidirectional edge is written once
     for (y = 0; y < _height; ++y) {
       for (x = 0; x < _width; ++x) {
-        cell& c = _cells[y][x];
-        for (int e_count = 0; e_count < num_dirs; ++e_count) {
-          edge& e = c.adjacents[e_count];
-          if (!valid_edge(e)) continue;
+        cell_id id = index(x, y);
+        for (direction dir : {direction::SOUTH, direction::EAST}) {
+          if (!passage(id, dir)) continue;
+          edge e(x, y, x + dir_dx[int(dir)], y + dir_dy[int(dir)]);
           save_svg_edge(out, e, magnification);
-          set_visited(e, e_count);
         }
       }
     }
@@ -262,7 +520,7 @@ bool mazer2018::data::maze::save_svg(const std::string& name) {
   return out.good();
 }
 
-bool mazer2018::data::maze::save_svg_func(const std::string &name) {
+bool mazer2018::data::maze::save_svg_func(const std::string &name) const {
 	std::fstream output(name, std::fstream::out | std::fstream::trunc);
 	if (!output.is_open())
 	{
@@ -270,56 +528,54 @@ bool mazer2018::data::maze::save_svg_func(const std::string &name) {
 		return false;
 	}
 
-	// header
-	int offset = 4;
-	int box_width = 20 * _width + offset;
-	int box_height = 20 * _height + offset;
-	output << "<svg width='" << box_width << "' ";
-	output << "height='" << box_height << "' ";
-	output << "xmlns='http://www.w3.org/2000/svg'>" << "\n";
-
-	output << "<rect width='" << box_width << "' height='" << box_height;
-	output << "' style='fill: black' />" << "\n";
-
-	std::vector<data::edge *> solve_edge;
-	std::vector<data::edge *> unsolve_edge;
+	save_svg_open(output, _width, _height);
 
+	// passages are drawn first and the solution on top of them
 	for (int y = 0; y < _height; y++) {
 		for (int x = 0; x < _width; x++) {
-			for (int k = 0; k < _cells[x][y].adjacents.size(); k++) {
-				data::edge *cur_edge = &(_cells[x][y].adjacents[k]);
-				//std::cout << "cell " << x << ", " << y << std::endl;
-				if (cur_edge->is_solve){
-
-					solve_edge.push_back(cur_edge);
-				}
-				else {
-					unsolve_edge.push_back(cur_edge);
+			cell_id id = index(x, y);
+			for (direction dir : {direction::SOUTH, direction::EAST}) {
+				if (!passage(id, dir)) {
+					continue;
 				}
+				data::edge cur_edge(x, y, x + dir_dx[int(dir)], y + dir_dy[int(dir)]);
+				save_svg_edge(&cur_edge, output);
 			}
 		}
 	}
 
-	/*
-	unsolve_edge.clear();
-	unsolve_edge.push_back(&data::edge(0, 0, 1, 0));
-	unsolve_edge.push_back(&data::edge(0, 0, 0, 1));
-	unsolve_edge.push_back(&data::edge(1, 0, 1, 1));
-	*/
-	
-
 	//save path
-	for (auto *cur_edge : unsolve_edge)
+	for (const data::edge &cur_edge : _solution)
 	{
-		save_svg_edge(cur_edge, output);
-	}
-	for (auto *cur_edge : solve_edge)
-	{
-		save_svg_edge(cur_edge, output);
+		save_svg_edge(&cur_edge, output);
 	}
 
+	save_svg_close(output, _width, _height, !_solution.empty());
+	output.close();
+	return true;
+}
+
+void mazer2018::data::maze::save_svg_open(std::ostream &output, int width,
+                                          int height) {
+	// header
+	int offset = 4;
+	int box_width = 20 * width + offset;
+	int box_height = 20 * height + offset;
+	output << "<svg width='" << box_width << "' ";
+	output << "height='" << box_height << "' ";
+	output << "xmlns='http://www.w3.org/2000/svg'>" << "\n";
+
+	output << "<rect width='" << box_width << "' height='" << box_height;
+	output << "' style='fill: black' />" << "\n";
+}
+
+void mazer2018::data::maze::save_svg_close(std::ostream &output, int width,
+                                           int height, bool solved) {
+	int offset = 4;
+	int box_width = 20 * width + offset;
+	int box_height = 20 * height + offset;
+
 	// entry and exit
-	bool solved = !solve_edge.empty();
 	output << "<rect style='fill:";
 	if (solved)
 		output << "rgb(255, 0, 0)";
@@ -340,10 +596,9 @@ bool mazer2018::data::maze::save_svg_func(const std::string &name) {
 	output << "' height='" << edge_width << "'/>" << "\n";
 
 	output << "</svg>" << "\n";
-	output.close();
-	return true;
 }
-void mazer2018::data::maze::save_svg_edge(data::edge *edge, std::fstream & output) {
+
+void mazer2018::data::maze::save_svg_edge(const data::edge *edge, std::ostream & output) {
 	int x, y;
 	int edge_width, edge_height;
 
@@ -395,36 +650,140 @@ void mazer2018::data::maze::save_svg_edge(data::edge *edge, std::fstream & outpu
 	output << "' height='" << edge_height << "'/>" << "\n";
 }
 
-void mazer2018::data::maze::set_unvisited(void) {
-  // iterate over each cell
-  for (int y_count = 0; y_count < _height; ++y_count) {
-    for (int x_count = 0; x_count < _width; ++x_count) {
-      // set all of its edges to not been visited
-      for (int e_count = 0; e_count < num_dirs; ++e_count) {
-        _cells[y_count][x_count].adjacents[e_count].visited = false;
-      }
+std::int64_t mazer2018::data::maze::edge_count(void) const {
+  // every passage is a single bit in the grid
+  return std::int64_t(_grid.count());
+}
+
+/**
+ * any bit of an interior cell is a passage between two cells of the maze,
+ * so the only bits that can lead out of it are the east bits of the last
+ * column, the south bits of the last row and the bits of padding cells.
+ **/
+bool mazer2018::data::maze::consistent(void) const {
+  for (int y = 0; y < _height; ++y) {
+    if (_grid.east(index(_width - 1, y))) return false;
+  }
+  for (int x = 0; x < _width; ++x) {
+    if (_grid.south(index(x, _height - 1))) return false;
+  }
+  const int padded_width = _layout.padded_width(),
+            padded_height = _layout.padded_height();
+  for (int y = 0; y < padded_height; ++y) {
+    for (int x = y < _height ? _width : 0; x < padded_width; ++x) {
+      cell_id id = index(x, y);
+      if (_grid.east(id) || _grid.south(id)) return false;
     }
   }
+  return true;
 }
 
-int mazer2018::data::maze::edge_count(void) {
-  int edge_counter = 0;
-  // iterate over the cells vector
-  for (int y_count = 0; y_count < _height; ++y_count) {
-    for (int x_count = 0; x_count < _width; ++x_count) {
-      // for each edge going out from this cell, set it to
-      // visited and increment the count of edges
-      for (int e_count = 0; e_count < num_dirs; ++e_count) {
-        cell& c = _cells[y_count][x_count];
-        edge& e = c.adjacents[e_count];
-        if (valid_edge(e) && !e.visited) {
-          set_visited(e, e_count);
-          ++edge_counter;
-        }
-      }
+/**
+ * @param x the x coordinate of the cell
+ * @param y the y coordinate of the cell
+ **/
+std::vector<mazer2018::data::edge> mazer2018::data::maze::adjacents(
+    int x, int y) const {
+  std::vector<edge> edges(num_dirs);
+  for_each_neighbour(index(x, y), [&](cell_id, direction dir) {
+    edges[int(dir)] =
+        edge(x, y, x + dir_dx[int(dir)], y + dir_dy[int(dir)]);
+  });
+  return edges;
+}
+
+/**
+ * @param e the edge describing the passage to open
+ **/
+bool mazer2018::data::maze::add_edge(const edge& e) {
+  if (!valid_edge(e)) return false;
+  direction dir = get_dir(e.in_x, e.in_y, e.out_x, e.out_y);
+  if (dir == direction::INVALID) return false;
+  set_passage(e.in_x, e.in_y, dir, true);
+  return true;
+}
+
+/**
+ * a row starts part way through a block of the passage grid, so each word
+ * of the row is split between two blocks. Bits past the end of the row are
+ * never set, so the second block only gets bits when it holds cells of the
+ * row.
+ **/
+void mazer2018::data::maze::open_row(int y, const std::uint64_t* east,
+                                     const std::uint64_t* south) {
+  const std::size_t words = (std::size_t(_width) + 63) / 64;
+  std::uint64_t* grid = _grid.words();
+  if (layout() != layout_type::ROW_MAJOR || !grid) {
+    for (int x = 0; x < _width; ++x) {
+      const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+      cell_id id = index(x, y);
+      if (east[x >> 6] & bit) set_passage(id, direction::EAST, true);
+      if (south[x >> 6] & bit) set_passage(id, direction::SOUTH, true);
+    }
+    return;
+  }
+  const std::uint64_t first = std::uint64_t(y) * std::uint64_t(_width);
+  const int shift = int(first & 63);
+  std::uint64_t* block = grid + 2 * (first >> 6);
+  for (std::size_t i = 0; i < words; ++i, block += 2) {
+    block[0] |= east[i] << shift;
+    block[1] |= south[i] << shift;
+    if (shift == 0) continue;
+    const std::uint64_t east_over = east[i] >> (64 - shift),
+                        south_over = south[i] >> (64 - shift);
+    if (east_over | south_over) {
+      block[2] |= east_over;
+      block[3] |= south_over;
+    }
+  }
+}
+
+/**
+ * as in @ref open_row each word of the row is split between two blocks.
+ * The second block is only read while it holds cells of the row, so
+ * nothing past the end of the grid is read, and the bits of the next row
+ * that come with the last word are masked off.
+ **/
+void mazer2018::data::maze::read_row(int y, std::uint64_t* east,
+                                     std::uint64_t* south) const {
+  const std::size_t words = (std::size_t(_width) + 63) / 64;
+  const std::uint64_t* grid = _grid.words();
+  if (layout() != layout_type::ROW_MAJOR || !grid) {
+    std::fill(east, east + words, 0);
+    std::fill(south, south + words, 0);
+    for (int x = 0; x < _width; ++x) {
+      const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+      cell_id id = index(x, y);
+      if (_grid.east(id)) east[x >> 6] |= bit;
+      if (_grid.south(id)) south[x >> 6] |= bit;
     }
+    return;
   }
-  return edge_counter;
+  const std::uint64_t first = std::uint64_t(y) * std::uint64_t(_width);
+  const int shift = int(first & 63);
+  const std::uint64_t last_block = (first + std::uint64_t(_width) - 1) >> 6;
+  const std::uint64_t* block = grid + 2 * (first >> 6);
+  for (std::size_t i = 0; i < words; ++i, block += 2) {
+    east[i] = block[0] >> shift;
+    south[i] = block[1] >> shift;
+    if (shift && (first >> 6) + i < last_block) {
+      east[i] |= block[2] << (64 - shift);
+      south[i] |= block[3] << (64 - shift);
+    }
+  }
+  if (_width & 63) {
+    const std::uint64_t end = ~std::uint64_t(0) >> (64 - (_width & 63));
+    east[words - 1] &= end;
+    south[words - 1] &= end;
+  }
+}
+
+/**
+ * @param e the solution edge to record
+ **/
+void mazer2018::data::maze::mark_solution(const edge& e) {
+  _solution.push_back(e);
+  _solution.back().is_solve = true;
 }
 
 /**
@@ -449,21 +808,22 @@ mazer2018::data::direction mazer2018::data::get_dir(const int in_x,
     return direction::INVALID;
   } else {
     // check that the coordinates are one space apart
-    if (std::abs(diff_x) != 1 && std::abs(diff_y) != 1) {
+    if (std::abs(diff_x) + std::abs(diff_y) != 1) {
       std::cerr << "error: invalid coordinates given" << std::endl;
+      return direction::INVALID;
     }
     // calculate direction based on difference between the coordinates
     // passed in
     if (diff_x == 0) {
       if (diff_y == -1)
-        return direction::NORTH;
-      else
         return direction::SOUTH;
+      else
+        return direction::NORTH;
     } else {
       if (diff_x == -1)
-        return direction::WEST;
-      else
         return direction::EAST;
+      else
+        return direction::WEST;
     }
   }
   return direction::INVALID;
@@ -475,7 +835,7 @@ mazer2018::data::direction mazer2018::data::get_dir(const int in_x,
  * @return true when there has been no i/o error and false otherwise
  **/
 void mazer2018::data::maze::save_svg_prologue(std::ofstream& out,
-                                              double magnification) {
+                                              double magnification) const {
   out << "<svg width=\"";
   out << std::floor((_width - 1) * magnification) << "\" height=\""
       << std::floor((_height - 1) * magnification) << "\" xmlns=\"";
@@ -486,7 +846,7 @@ void mazer2018::data::maze::save_svg_prologue(std::ofstream& out,
  * @param out the stream to write the svg data to
  * return true when there has been no i/o error and false otherwise
  **/
-void mazer2018::data::maze::save_svg_epilogue(std::ofstream& out) {
+void mazer2018::data::maze::save_svg_epilogue(std::ofstream& out) const {
   out << "</svg>" << std::endl;
 }
 
@@ -498,7 +858,7 @@ void mazer2018::data::maze::save_svg_epilogue(std::ofstream& out) {
  **/
 void mazer2018::data::maze::save_svg_edge(std::ofstream& out,
                                           const mazer2018::data::edge& e,
-                                          double magnification) {
+                                          double magnification) const {
   out << "<line stroke=\"white\" x1=\"" << e.in_x * magnification << "\" x2=\""
       << e.out_x * magnification << "\" y1=\"" << e.in_y * magnification
       << "\" y2=\"" << e.out_y * magnification << "\" stroke-width=\""
@@ -511,73 +871,35 @@ void mazer2018::data::maze::save_svg_edge(std::ofstream& out,
  * @return true when there has been no i/o error and false otherwise
  **/
 void mazer2018::data::maze::save_svg_background(std::ofstream& out,
-                                                double magnification) {
+                                                double magnification) const {
   out << "<rect width=\"" << _width * magnification << "\" height=\""
       << _height * magnification << "\" style=\"fill:black\" />" << std::endl;
 }
 
-/**
- * @param e the edge we wish to set as visited
- * @param e_index the index into the cell's edges that represents
- * the direction of the edge
- **/
-void mazer2018::data::maze::set_visited(edge& e, int e_index) {
-  // if this is a valid edge that we haven't visited, mark it so
-  if (valid_edge(e) && !e.visited) {
-    // grab the opposing edge
-    cell& other_c = _cells[e.out_y][e.out_x];
-    edge& other_e = other_c.adjacents[int(!direction(e_index))];
-    // set them both to visited
-    other_e.visited = e.visited = true;
-  }
-}
-
 /**
  * @param x the x coordinate where we wish to insert a wall
  * @param y the y coordinate where we wisht to insert a wall
  * @param orient the current orientation (horizontal or vertical)
  **/
 void mazer2018::data::maze::insert_wall(int x, int y, orientation orient) {
-  // initialize a new edge that we are inserting
-  edge e;
-  e.in_y = y;
-  e.in_x = x;
-  e.visited = false;
   // we need to handle horizontal and vertical separately
   if (orient == orientation::VERTICAL) {
     // insert an upper edge
     if (y > 0) {
-      e.out_y = y - 1;
-      e.out_x = x;
-      _cells[y][x].adjacents[int(direction::NORTH)] = e;
-      // reverse the edge as it should be two-way
-      edge other_e = !e;
-      _cells[e.out_y][e.out_x].adjacents[int(direction::SOUTH)] = other_e;
+      set_passage(x, y, direction::NORTH, true);
     }
     // insert a lower edge
-    if (y < _width - 1) {
-      e.out_y = y + 1;
-      _cells[y][x].adjacents[int(direction::SOUTH)] = e;
-      // grab the reverse edge as it should be two-way
-      edge other_e = !e;
-      _cells[y + 1][x].adjacents[int(direction::NORTH)] = other_e;
+    if (y < _height - 1) {
+      set_passage(x, y, direction::SOUTH, true);
     }
   } else {
-    // right edge
+    // left edge
     if (x > 0) {
-      e.out_x = x - 1;
-      e.out_y = y;
-      _cells[y][x].adjacents[int(direction::EAST)] = e;
-      edge other_e = !e;
-      _cells[y][x - 1].adjacents[int(direction::WEST)] = other_e;
+      set_passage(x, y, direction::WEST, true);
     }
-    // left edge
+    // right edge
     if (x < _width - 1) {
-      e.out_x = x + 1;
-      e.out_y = y;
-      _cells[y][x].adjacents[int(direction::WEST)] = e;
-      edge other_e = !e;
-      _cells[y][x + 1].adjacents[int(direction::EAST)] = other_e;
+      set_passage(x, y, direction::EAST, true);
     }
   }
 }
@@ -600,44 +922,20 @@ bool mazer2018::data::maze::valid_dim(const int dim) {
 void mazer2018::data::maze::delete_wall(int x, int y, orientation orient) {
   // we have to deal with the vertical and horizontal case separately
   if (orient == orientation::VERTICAL) {
-    // grab the y coordinate of the upper cell from here
-    edge& e = _cells[y][x].adjacents[int(direction::NORTH)];
-    int out_y = e.out_y;
-    // remove the outgoing upper edge
-    e.out_y = constants::ERROR;
-    // if the outgoing upper edge was valid, grab the opposite edge
-    // and wipe it out as well
-    if (out_y != constants::ERROR) {
-      edge& other_e = _cells[out_y][x].adjacents[int(direction::SOUTH)];
-      other_e.out_y = constants::ERROR;
+    // remove the upper and lower edges from here
+    if (y > 0) {
+      set_passage(x, y, direction::NORTH, false);
     }
-    // perform the same actions for an edge going down from here
-    e = _cells[y][x].adjacents[int(direction::SOUTH)];
-    out_y = e.out_y;
-    e.out_y = constants::ERROR;
-    if (out_y != constants::ERROR) {
-      edge& other_e = _cells[out_y][x].adjacents[int(direction::NORTH)];
-      other_e.out_y = constants::ERROR;
+    if (y < _height - 1) {
+      set_passage(x, y, direction::SOUTH, false);
     }
   } else {
-    // horizontal
-    // grap the edge to the left of here and wipe it out
-    edge& e = _cells[y][x].adjacents[int(direction::WEST)];
-    int out_x = e.out_x;
-    e.out_x = constants::ERROR;
-    // if the edge was previously valid, grab the opposing edge
-    // and wipe it out.
-    if (out_x != constants::ERROR) {
-      edge& other_e = _cells[y][out_x].adjacents[int(direction::EAST)];
-      other_e.out_x = constants::ERROR;
+    // horizontal - remove the edges to the left and right of here
+    if (x > 0) {
+      set_passage(x, y, direction::WEST, false);
     }
-    // perform the same actions for an edge to the right of here.
-    e = _cells[y][x].adjacents[int(direction::EAST)];
-    out_x = e.out_x;
-    e.out_x = constants::ERROR;
-    if (out_x != constants::ERROR) {
-      edge& other_e = _cells[y][out_x].adjacents[int(direction::WEST)];
-      other_e.out_x = constants::ERROR;
+    if (x < _width - 1) {
+      set_passage(x, y, direction::EAST, false);
     }
   }
 }
@@ -1,14 +1,19 @@
 #include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <stack>
 #include <algorithm>
-#include "../args/action.h"
 #include "../constants/constants.h"
+#include "arena.h"
+#include "layout.h"
+#include "mask.h"
+#include "types.h"
+#include "wall_grid.h"
 
 #pragma once
 namespace mazer2018 {
@@ -41,44 +46,12 @@ orientation operator!(const orientation);
  **/
 const int NUM_ORIENTATIONS = 2;
 
-/**
- * enumeration that represents a direction from a cell in terms
- * of the traditional cardinal directions: north, south, etc.
- **/
-enum class direction {
-  /**
-   * represents a cell above the current cell
-   **/
-  NORTH,
-  /**
-   * represents a cell below the current cell
-   **/
-  SOUTH,
-  /**
-   * represents a cell to the left of the current cell
-   **/
-  EAST,
-  /**
-   * represents a cell to the right of the current cell
-   **/
-  WEST,
-  /**
-   * represents an invalid direction
-   **/
-  INVALID
-};
-
 /**
  * operator function that turns its direction into its opposite -
  * north becomes south, etc.
  **/
 const direction operator!(const direction);
 
-/**
- * the number of valid directions from a cell
- **/
-const int num_dirs = 4;
-
 /**
  * calculates the direction of a specified x,y-x,y coordinates.
  * Note that the direction will ge invalid if they are in a
@@ -91,8 +64,10 @@ direction get_dir(const int in_x, const int in_y, const int out_x,
  * struct that represents an edge in the maze. We have the in
  * coordinates which are the coordinates of the current cell and
  * out coordinates which are the coordinates of the destination
- * cell. We also have a boolean for whether this edge has been
- * visited so we don't process an edge twice.
+ * cell. Edges are no longer stored inside the maze - the maze keeps its
+ * passages in a @ref wall_grid - but they are still used to describe a
+ * passage when reading and writing files and as a view of a cell's
+ * neighbours.
  **/
 struct edge {
   /// the cell's x coordinate
@@ -103,8 +78,7 @@ struct edge {
       out_x,
       /// the edge's destination y coordinate
       out_y;
-  /// whether this edge has been visited in the current algorithm
-  bool visited;
+  /// whether this edge is part of the solution to the maze
   bool is_solve;
 
   /**
@@ -117,14 +91,14 @@ struct edge {
         in_y(constants::ERROR),
         out_x(constants::ERROR),
         out_y(constants::ERROR),
-        visited(false), is_solve(false) {}
+        is_solve(false) {}
 
   /**
    * need to provide a parameterised constructor if I provide
    * a default or it becomes hidden
    **/
   edge(int x1, int y1, int x2, int y2)
-      : in_x(x1), in_y(y1), out_x(x2), out_y(y2), visited(false), is_solve(false) {}
+      : in_x(x1), in_y(y1), out_x(x2), out_y(y2), is_solve(false) {}
 };
 
 /**
@@ -133,49 +107,6 @@ struct edge {
  **/
 edge operator!(const edge&);
 
-/**
- * struct that represents a cell in the maze. It has an x,y
- * coordinate, and a vector of edges from this cell to other
- * cells
- **/
-struct cell {
-  /// the x coordinate of the current cell
-  int x
-      /// the cell's y coordinate
-      ,
-      y;
-  /// vector of edges that link to adjacent cells
-  std::vector<edge> adjacents;
-  bool is_visited;
-  cell *prev;
-
-  /**
-   * default constructor - initializes the adjacents vector to
-   * a vector of size 4 and this cell's coordinates to an
-   * empty location
-   **/
-  cell(void) : x(constants::ERROR), y(constants::ERROR), adjacents(num_dirs), is_visited(false), prev(nullptr){}
-
-  /**
-   * constructor which takes the coordinates of the cells and
-   * initializes the adjacents vector to a size of 4.
-   **/
-  cell(int _x, int _y) : x(_x), y(_y), adjacents(num_dirs), is_visited(false), prev(nullptr) {}
-};
-
-struct HashFunc{
-  std::size_t operator()(const cell *cell) const{
-    return cell->x ^ cell->y;
-  }
-};
-
-struct EqualFunc{
-  bool operator() (const cell *c1, const cell *c2) const{
-    return c1->x == c2->x && c1->y == c2->y;
-  }
-};
-
-
 /**
  * the maze class itself - represents a maze which has been
  * generated or loaded
@@ -185,23 +116,67 @@ class maze {
   int _width,
       /// the height of the maze
       _height;
-  /// the vector of vector of cells that represents the maze itself
-  std::vector<std::vector<cell>> _cells;
+  /// the order the cells of the maze are stored in
+  cell_layout _layout;
+  /// the passages between the cells of the maze
+  wall_grid _grid;
+  /// the edges that make up the solution to this maze, if it has been solved
+  std::vector<edge> _solution;
+  /// the cells in use when the maze is cut out of a shape, or nullptr if
+  /// every cell is in use
+  std::unique_ptr<cell_mask> _mask;
   /// has this maze been initialized?
   bool _initialized;
 
+  /**
+   * loads the rest of a version 1 binary file once the header has been
+   * read
+   **/
+  bool load_binary_v1(std::ifstream&);
+
+  /**
+   * loads a version 2 binary file once the magic number has been read
+   **/
+  bool load_binary_v2(std::ifstream&);
+
+  /**
+   * maps a version 2 binary file read-only and uses it in place
+   **/
+  bool load_binary_mapped(const std::string&);
+
+  /**
+   * checks the header of a version 2 binary file and adopts its size and
+   * layout. The grid is not touched.
+   **/
+  bool read_header(const binary_header&);
+
+  /**
+   * fills in the header of the maze file this maze is mapped onto, if
+   * any, except for the count of passages
+   **/
+  void write_header(void);
+
   /// the maximum resolution for outputting as svg - required
   /// by my algorithm. Note that under c++11 onwards if I
   /// initalize a static inside the class it must be a constexpr
   ///, that is, it must be resolvable at compile time.
   constexpr static const double MAXRES = 500;
 
+  /**
+   * rebuilds the layout and reallocates the passage grid to match the
+   * current width and height.
+   * The grid is a single flat buffer so this costs a constant number of
+   * allocations whatever the size of the maze. The mask is kept if it is
+   * still the right size, in which case the grid is sparse.
+   **/
+  void resize(void);
+
  public:
   /**
    * default constructor - constructs a maze of 0 width and
    * height and puts the maze in an uninitialized state.
    **/
-  maze(void) : _width(0), _height(0), _cells(0), _initialized(false) {}
+  maze(void) : _width(0), _height(0), _initialized(false) {}
 
   /**
    * parameterized constructor - constructs a maze of the
@@ -210,13 +185,25 @@ class maze {
    * @param width the width of the maze to create
    * @param height the height of the maze to create
    **/
-  maze(int width, int height)
+  maze(int width, int height, layout_type layout = layout_type::ROW_MAJOR)
       : _width(width),
         _height(height),
-        // initialize the _cells vector to be the correct
-        // width and height
-        _cells(height, std::vector<cell>(width)),
-        _initialized(false) {}
+        _layout(layout, width, height),
+        _initialized(false) {
+    resize();
+  }
+
+  /**
+   * a maze may own a memory mapping so it can't be copied
+   **/
+  maze(const maze&) = delete;
+  maze& operator=(const maze&) = delete;
+
+  /**
+   * destructor - brings the file this maze is mapped onto, if any, up to
+   * date
+   **/
+  ~maze(void);
 
   /**
    * returns whether this maze has been initialized or not.
@@ -225,17 +212,6 @@ class maze {
    **/
   bool initialized(void) { return _initialized; }
 
-  /**
-   * @return a reference to the cells vector to manipulate
-   * that locally. If you have a handle to a maze you should
-   * have access to the cells. I thought about making cells
-   * public but by implementing this in the class declaration,
-   * there is no time overhead to call this function and
-   * there is no space overhead for it being an inline function
-   * as there is only a return statement anyway.
-   **/
-  std::vector<std::vector<cell>>& get_cells(void) { return _cells; }
-
   /**
    * getter for the height of the maze
    * @return the maze height
@@ -243,17 +219,12 @@ class maze {
   int height() const { return _height; }
 
   /**
-   * setter for the maze height. It sets the height then
-   * resizes the _cells vector to match that height and
-   * each row vector to match the current width
+   * setter for the maze height. The maze is left without any passages.
    * @param h the new height for this maze.
    **/
   void height(const int h) {
     _height = h;
-    // change the height of the adjacency matrix
-    _cells.resize(h);
-    // change the width of the adjacency matrix
-    for (auto& element : _cells) element.resize(_width);
+    resize();
   }
 
   /**
@@ -262,89 +233,399 @@ class maze {
   int width() const { return _width; }
 
   /**
-   * change the width of this maze.
-   * changing the width of this maze means resizing each row
-   * of the adjacency matrix
+   * change the width of this maze. The maze is left without any passages.
    **/
   void width(const int w) {
     _width = w;
-    // resize each row
-    for (auto& element : _cells) {
-      element.resize(w);
+    resize();
+  }
+
+  /**
+   * @return the order the cells of this maze are stored in
+   **/
+  layout_type layout(void) const { return _layout.type(); }
+
+  /**
+   * changes the order the cells of this maze are stored in. Any passages
+   * are copied across to the new layout.
+   **/
+  void layout(layout_type type);
+
+  /**
+   * @return the number of cells in this maze
+   **/
+  cell_id size(void) const { return cell_id(_width) * _height; }
+
+  /**
+   * @return the number of cell handles this maze uses, which may be more
+   * than @ref size when the layout pads the maze. Valid cell handles are
+   * 0 to capacity() - 1 and per cell arrays should be this long.
+   **/
+  cell_id capacity(void) const { return _layout.capacity(); }
+
+  /**
+   * @return the handle of the cell at x, y
+   **/
+  cell_id index(int x, int y) const { return _layout.index(x, y); }
+
+  /**
+   * @return the x coordinate of a cell
+   **/
+  int x_of(cell_id id) const { return _layout.x_of(id); }
+
+  /**
+   * @return the y coordinate of a cell
+   **/
+  int y_of(cell_id id) const { return _layout.y_of(id); }
+
+  /**
+   * @return whether x, y is a cell within this maze
+   **/
+  bool valid_cell(int x, int y) const {
+    return x >= 0 && x < _width && y >= 0 && y < _height;
+  }
+
+  /**
+   * @return the handle of the neighbour of a cell in the direction
+   * specified. The neighbour must exist - see @ref has_neighbour.
+   **/
+  cell_id neighbour(cell_id id, direction dir) const {
+    return _layout.neighbour(id, dir);
+  }
+
+  /**
+   * @return whether a cell has a neighbour in the direction specified
+   * or whether it is on that edge of the maze. A neighbour outside the
+   * mask doesn't count.
+   **/
+  bool has_neighbour(cell_id id, direction dir) const {
+    return valid_cell(x_of(id) + dir_dx[int(dir)],
+                      y_of(id) + dir_dy[int(dir)]) &&
+           (!_mask || _mask->test(neighbour(id, dir)));
+  }
+
+  /**
+   * @return whether a cell is in use - true unless the maze has a mask
+   * that leaves it out
+   **/
+  bool active(cell_id id) const { return !_mask || _mask->test(id); }
+
+  /**
+   * @return whether this maze is cut out of a mask
+   **/
+  bool masked(void) const { return _mask != nullptr; }
+
+  /**
+   * @return the mask this maze is cut out of or nullptr
+   **/
+  const cell_mask* mask(void) const { return _mask.get(); }
+
+  /**
+   * loads a mask from a pbm file. The maze takes the size of the bitmap
+   * and is left without passages; only the cells that are black in the
+   * bitmap are used by a generator. The passage grid of a masked maze is
+   * sparse so memory follows the size of the shape rather than the
+   * bitmap.
+   * @return false if the file could not be read
+   **/
+  bool load_mask(const std::string&);
+
+  /**
+   * @return whether the passage grid is held in sparse storage
+   **/
+  bool sparse(void) const { return _grid.sparse(); }
+
+  /**
+   * makes this a procedural maze of the size given whose passages are
+   * worked out a 64x64 tile at a time by source as they are read. Only
+   * the tiles read most recently are kept, up to the number given, so
+   * the maze is ready at once and holds a bounded amount of memory
+   * however big it is. It uses the tiled64 layout, has no mask and can
+   * be read but not changed until it is resized, generated over or
+   * loaded over.
+   **/
+  void procedural(int width, int height, std::unique_ptr<tile_source> source,
+                  std::size_t tiles);
+
+  /**
+   * @return whether the passages of this maze are worked out as they are
+   * read - see @ref procedural
+   **/
+  bool procedural(void) const { return _grid.procedural(); }
+
+  /**
+   * @return the cell generators start from and the solver starts at - the
+   * top left cell, or the first cell in the mask
+   **/
+  cell_id first_cell(void) const {
+    return _mask ? _mask->first() : index(0, 0);
+  }
+
+  /**
+   * @return the cell the solver finishes at - the bottom right cell, or
+   * the last cell in the mask
+   **/
+  cell_id last_cell(void) const {
+    return _mask ? _mask->last() : index(_width - 1, _height - 1);
+  }
+
+  /**
+   * @return whether there is a passage from a cell to its neighbour in
+   * the direction specified. Passages are never opened through the
+   * outside of the maze so the east bit of the last column, the south
+   * bit of the last row and both bits of any padding cell are always
+   * clear. That means the only bounds check needed is for a step north
+   * or west that would fall before the first handle.
+   **/
+  bool passage(cell_id id, direction dir) const {
+    switch (dir) {
+      case direction::NORTH: {
+        cell_id other = _layout.neighbour(id, dir);
+        return other >= 0 && _grid.south(other);
+      }
+      case direction::SOUTH:
+        return _grid.south(id);
+      case direction::EAST:
+        return _grid.east(id);
+      case direction::WEST: {
+        cell_id other = _layout.neighbour(id, dir);
+        return other >= 0 && _grid.east(other);
+      }
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * @return whether there is a passage from the cell at x, y to its
+   * neighbour in the direction specified. x, y must be a valid cell.
+   **/
+  bool passage(int x, int y, direction dir) const {
+    return passage(index(x, y), dir);
+  }
+
+  /**
+   * opens or closes the passage from a cell to its neighbour in the
+   * direction specified. The neighbour must be within the maze.
+   **/
+  void set_passage(cell_id id, direction dir, bool open) {
+    switch (dir) {
+      case direction::NORTH:
+        _grid.set_south(_layout.neighbour(id, dir), open);
+        break;
+      case direction::SOUTH:
+        _grid.set_south(id, open);
+        break;
+      case direction::EAST:
+        _grid.set_east(id, open);
+        break;
+      case direction::WEST:
+        _grid.set_east(_layout.neighbour(id, dir), open);
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * opens the passage from a cell to its neighbour in the direction
+   * specified while other threads are opening passages of other cells -
+   * see @ref wall_grid::open_east_shared. The maze must not be sparse.
+   **/
+  void open_passage_shared(cell_id id, direction dir) {
+    switch (dir) {
+      case direction::NORTH:
+        _grid.open_south_shared(_layout.neighbour(id, dir));
+        break;
+      case direction::SOUTH:
+        _grid.open_south_shared(id);
+        break;
+      case direction::EAST:
+        _grid.open_east_shared(id);
+        break;
+      case direction::WEST:
+        _grid.open_east_shared(_layout.neighbour(id, dir));
+        break;
+      default:
+        break;
     }
   }
 
+  /**
+   * opens or closes the passage from the cell at x, y to its neighbour
+   * in the direction specified. Both cells must be within the maze.
+   **/
+  void set_passage(int x, int y, direction dir, bool open) {
+    set_passage(index(x, y), dir, open);
+  }
+
+  /**
+   * calls f(out, dir) for each neighbour of a cell that can be reached
+   * through an open passage.
+   **/
+  template <class F>
+  void for_each_neighbour(cell_id id, F f) const {
+    for (int d = 0; d < num_dirs; ++d) {
+      if (passage(id, direction(d))) {
+        f(neighbour(id, direction(d)), direction(d));
+      }
+    }
+  }
+
+  /**
+   * @return the edges out of the cell at x, y indexed by direction. A
+   * direction without a passage holds an empty (invalid) edge. This is a
+   * view built on demand from the passage grid.
+   **/
+  std::vector<edge> adjacents(int x, int y) const;
+
+  /**
+   * opens the passage described by an edge between two adjacent cells.
+   * @return false if the edge is not a valid edge between adjacent cells
+   **/
+  bool add_edge(const edge&);
+
+  /**
+   * opens the passages of a whole row at once, given as the bit arrays
+   * of a @ref row_sink: bit x % 64 of word x / 64 is set for a passage
+   * from the cell in column x to its east or south. In a row-major maze
+   * that isn't sparse each word of the row is shifted straight into the
+   * passage grid; any other maze is filled in a cell at a time.
+   * @param y the row to open the passages of
+   **/
+  void open_row(int y, const std::uint64_t* east, const std::uint64_t* south);
+
+  /**
+   * reads the passages of a whole row at once into bit arrays laid out as
+   * for @ref open_row - the reverse of it. In a row-major maze that isn't
+   * sparse each word of the row is shifted straight out of the passage
+   * grid; any other maze is read a cell at a time.
+   * @param y the row to read the passages of
+   **/
+  void read_row(int y, std::uint64_t* east, std::uint64_t* south) const;
+
+  /**
+   * records that the passage described by an edge is part of the
+   * solution to this maze
+   **/
+  void mark_solution(const edge&);
+
+  /**
+   * @return the edges that make up the solution to this maze
+   **/
+  const std::vector<edge>& solution(void) const { return _solution; }
+
+  /**
+   * @return the passage grid that holds the topology of this maze
+   **/
+  const wall_grid& grid(void) const { return _grid; }
+
   /**
    * sets the initialized variable so that we don't try to
    * write out a maze that has not been generated.
    **/
   void init(void);
 
+  /**
+   * moves this maze into a newly created maze file which is mapped into
+   * memory, so that the file holds the maze from now on. Passages are
+   * written straight into the file, which is a valid version 2 binary
+   * file once @ref sync has been called.
+   * @throw args::action_failed if the file can't be created or mapped
+   **/
+  void map_file(const std::string&);
+
+  /**
+   * @return whether this maze is held in a memory mapped file
+   **/
+  bool mapped(void) const { return _grid.storage().mapped(); }
+
+  /**
+   * brings the header of the file this maze is mapped onto up to date
+   * and schedules the changed pages to be written out. Does nothing for a
+   * maze on the heap.
+   **/
+  void sync(void);
+
   /**
    * saves this maze in binary format.
    **/
-  bool save_binary(const std::string&);
+  bool save_binary(const std::string&) const;
 
   /**
    * loads a maze in binary format from a file and initializes
-   * the instance data of this maze with that data.
+   * the instance data of this maze with that data. Where the platform
+   * allows it a version 2 file is mapped read-only and shared rather
+   * than read, so loading costs nothing up front and processes that load
+   * the same file share one copy of it.
    **/
   bool load_binary(const std::string&);
 
   /**
    * saves this maze as an svg file.
    **/
-  bool save_svg(const std::string&);
+  bool save_svg(const std::string&) const;
+
+  bool save_svg_func(const std::string&) const;
+
+  /**
+   * writes the opening of an svg file written by @ref save_svg_func for
+   * a maze of the size specified - the svg tag and the background.
+   **/
+  static void save_svg_open(std::ostream&, int width, int height);
+
+  /**
+   * writes a passage to an svg file written by @ref save_svg_func
+   **/
+  static void save_svg_edge(const data::edge *edge, std::ostream & output);
 
-  bool save_svg_func(const std::string&);
-  void save_svg_edge(data::edge *edge, std::fstream & output);
+  /**
+   * writes the entry, the exit and the closing tag of an svg file written
+   * by @ref save_svg_func
+   * @param solved whether the entry and exit are drawn as part of a
+   * solution
+   **/
+  static void save_svg_close(std::ostream&, int width, int height,
+                             bool solved);
 
   /**
    * writes the svg prolog to a file.
    **/
-  void save_svg_prologue(std::ofstream&, double);
+  void save_svg_prologue(std::ofstream&, double) const;
 
   /**
    * writes the closing tag for an svg file to the file
    * specified.
    **/
-  void save_svg_epilogue(std::ofstream&);
+  void save_svg_epilogue(std::ofstream&) const;
 
   /**
    * saves an edge from this maze to an svg file.
    **/
-  void save_svg_edge(std::ofstream&, const edge&, double);
+  void save_svg_edge(std::ofstream&, const edge&, double) const;
 
   /**
    * writes the background rectangle for this maze to an
    * svg file
    **/
-  void save_svg_background(std::ofstream&, double);
-
-  /**
-   * sets every edge in this maze to be unvisited.
-   * This is necessary for some algorithms such as the
-   * saving of the svg file as we don't want to write
-   * edges to the file twice
-   **/
-  void set_unvisited(void);
+  void save_svg_background(std::ofstream&, double) const;
 
   /**
    * gets the number of edges in this maze
    **/
-  int edge_count(void);
+  std::int64_t edge_count(void) const;
 
   /**
-   * sets a particular edge to be visited. We pass in the
-   * e_index within a cell so we can set the opposing edge
-   * as well.
+   * @return whether every open passage in the grid joins two cells of
+   * the maze. This is only false for a grid loaded from a corrupt file.
+   * Only the last row and column and any padding are examined, so the
+   * check is cheap even for a mapped file.
    **/
-  void set_visited(edge& e, int e_index);
+  bool consistent(void) const;
 
   /**
    * is this a valid edge? a valid edge is one where all
-   * coordinates a valid reference within the _cells
-   * vector.
+   * coordinates are valid cells within the maze.
    **/
   bool valid_edge(const edge&) const;
 
@@ -361,95 +642,5 @@ class maze {
   void delete_wall(int, int, orientation);
 };
 
-	// set
-	template <class T>
-	class set
-	{
-	public:
-		set();
-		~set();
-
-		void insert(T *value);
-		bool remove(T *value);
-		void clear();
-		int get_size() const;
-		T *get_end();
-		T *get_by_idx(int idx);
-
-
-	private:
-		std::unordered_map<const T*, int, HashFunc, EqualFunc> set_map;
-		std::stack<T*> set_stack;
-	};
-
-	template <class T>
-	set<T>::set()
-	{
-		while (!set_stack.empty()) {
-			set_stack.pop();
-		}
-	}
-
-	template <class T>
-	set<T>::~set()
-	{
-		set_map.clear();
-		while (!set_stack.empty()) {
-			set_stack.pop();
-		}
-	}
-
-	// insert
-	template <class T>
-	void set<T>::insert(T *value)
-	{
-		value->is_visited = true;
-		set_map.insert({value, get_size() - 1 });
-		set_stack.push(value);
-	}
-
-	// clear
-	template <class T>
-	void set<T>::clear()
-	{
-		set_map.clear();
-		while (!set_stack.empty()) {
-			set_stack.pop();
-		}
-	}
-
-	// delete
-	template <class T>
-	bool set<T>::remove(T *value)
-	{
-		auto it = set_map.find(value);
-		if (it != set_map.end()) {
-			set_map.erase(it);
-			set_stack.pop();
-			return true;
-		}
-		return false;
-	}
-
-	template <class ValueType>
-	int set<ValueType>::get_size() const {
-		return set_map.size();
-	}
-
-	template <class T>
-	T *set<T>::get_end() {
-		if (set_stack.empty()) {
-			return nullptr;
-		}
-		return set_stack.top();
-	}
-
-	template <class T>
-	T *set<T>::get_by_idx(int idx) {
-		auto it = set_map.begin();
-		std::advance(it, idx % set_map.size());
-		return const_cast<T*>(it->first);
-	}
-
 }  // namespace data
 }  // namespace mazer2018
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+/**
+ * @file parallel.h defines the helpers used to spread work over several
+ * threads.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * @return the number of threads to use when the user asks for the number
+ * specified - 0 means one for each core
+ **/
+inline unsigned thread_count(unsigned requested) {
+  if (requested) return requested;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * runs f(task, worker) for every task from 0 to count - 1 on a pool of
+ * threads. Each worker takes the next task as soon as it has finished the
+ * last, so tasks that take different amounts of time still keep every
+ * thread busy. worker is from 0 to threads - 1 and is only ever used by
+ * one thread at a time, so it can index per thread scratch data. The
+ * calling thread is worker 0.
+ *
+ * If a task throws, the remaining tasks are skipped and the first
+ * exception is rethrown on the calling thread once every worker has
+ * stopped.
+ **/
+template <class F>
+void parallel_for(unsigned threads, std::size_t count, F f) {
+  threads = unsigned(std::min<std::size_t>(std::max(threads, 1u), count));
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_lock;
+  auto work = [&](unsigned worker) {
+    try {
+      for (std::size_t task = next++; task < count; task = next++) {
+        f(task, worker);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(error_lock);
+      if (!error) error = std::current_exception();
+      next = count;
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned worker = 1; worker < threads; ++worker) {
+    pool.emplace_back(work, worker);
+  }
+  work(0);
+  for (std::thread& t : pool) t.join();
+  if (error) std::rethrow_exception(error);
+}
+
+/**
+ * the tasks of a @ref parallel_tasks run, in a queue for each worker. A
+ * worker adds the tasks it spawns to the back of its own queue and takes
+ * its next task from the back too, so it works depth first through the
+ * tasks it spawned while they are still in its cache. A worker whose queue
+ * is empty steals from the front of another's, which holds the oldest -
+ * and for divide and conquer work the biggest - task it has left.
+ *
+ * The queues are locked rather than lock-free: a task is expected to run
+ * for much longer than it takes to lock a queue, and the caller keeps
+ * tasks that small on its own thread instead.
+ **/
+template <class T>
+class task_queues {
+  /// the tasks of one worker
+  struct queue {
+    std::mutex lock;
+    std::deque<T> tasks;
+  };
+  /// the queue of each worker
+  std::unique_ptr<queue[]> _queues;
+  /// the number of workers
+  unsigned _workers;
+  /// the number of tasks that have been pushed but not yet finished
+  std::atomic<std::size_t> _pending;
+
+ public:
+  explicit task_queues(unsigned workers)
+      : _queues(new queue[workers]), _workers(workers), _pending(0) {}
+
+  /**
+   * adds a task to the back of a worker's queue
+   **/
+  void push(unsigned worker, T task) {
+    ++_pending;
+    std::lock_guard<std::mutex> guard(_queues[worker].lock);
+    _queues[worker].tasks.push_back(std::move(task));
+  }
+
+  /**
+   * takes the newest task from a worker's own queue, or failing that
+   * steals the oldest task from the queue of another worker
+   * @return false if every queue was empty
+   **/
+  bool pop(unsigned worker, T& task) {
+    {
+      queue& own = _queues[worker];
+      std::lock_guard<std::mutex> guard(own.lock);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    for (unsigned i = 1; i < _workers; ++i) {
+      queue& victim = _queues[(worker + i) % _workers];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * records that a task taken with @ref pop has finished, after any tasks
+   * it spawned were pushed
+   **/
+  void finished(void) { --_pending; }
+
+  /**
+   * @return whether every task pushed has finished, in which case no more
+   * can be pushed
+   **/
+  bool done(void) const { return _pending == 0; }
+};
+
+/**
+ * runs f(task, worker, queues) for a root task and every task spawned from
+ * it on a pool of threads that steal work from each other - see
+ * @ref task_queues. f spawns a task by calling queues.push(worker, task).
+ * Returns once every task has finished. As with @ref parallel_for, worker
+ * is from 0 to threads - 1, the calling thread is worker 0, and the first
+ * exception thrown by a task is rethrown on the calling thread once the
+ * workers have stopped, skipping the tasks that are left.
+ **/
+template <class T, class F>
+void parallel_tasks(unsigned threads, T root, F f) {
+  threads = std::max(threads, 1u);
+  task_queues<T> queues(threads);
+  queues.push(0, std::move(root));
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex error_lock;
+  auto work = [&](unsigned worker) {
+    T task;
+    while (!failed && !queues.done()) {
+      // the tasks that are left are all running on other workers, which
+      // may yet spawn more
+      if (!queues.pop(worker, task)) {
+        std::this_thread::yield();
+        continue;
+      }
+      try {
+        f(task, worker, queues);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(error_lock);
+        if (!error) error = std::current_exception();
+        failed = true;
+      }
+      queues.finished();
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned worker = 1; worker < threads; ++worker) {
+    pool.emplace_back(work, worker);
+  }
+  work(0);
+  for (std::thread& t : pool) t.join();
+  if (error) std::rethrow_exception(error);
+}
+
+/**
+ * holds each of a fixed number of threads back until all of them have
+ * reached it, for work done in steps that each depend on the whole of the
+ * step before. The last thread to arrive runs a function before any are
+ * let go, so the work between two steps that only one thread should do
+ * needs no second barrier. The threads see everything that function and
+ * the step before did once they are let go.
+ *
+ * A thread that throws rather than reaching the barrier leaves the others
+ * waiting for good, so the work between barriers must not throw.
+ **/
+class barrier {
+  std::mutex _lock;
+  std::condition_variable _released;
+  /// the number of threads that meet at the barrier
+  unsigned _threads;
+  /// the number of threads waiting for the rest
+  unsigned _waiting;
+  /// the number of times the threads have been let go
+  std::size_t _generation;
+
+ public:
+  explicit barrier(unsigned threads)
+      : _threads(threads), _waiting(0), _generation(0) {}
+
+  /**
+   * waits for every other thread to reach the barrier. The last to
+   * arrive calls last() and then lets them all go.
+   **/
+  template <class F>
+  void wait(F last) {
+    std::unique_lock<std::mutex> guard(_lock);
+    const std::size_t generation = _generation;
+    if (++_waiting == _threads) {
+      last();
+      _waiting = 0;
+      ++_generation;
+      _released.notify_all();
+      return;
+    }
+    _released.wait(guard, [&] { return _generation != generation; });
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <utility>
+
+#pragma once
+/**
+ * @file random.h defines the hashing and random number generator that
+ * generators use to derive independent random numbers from a seed.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * @return a well mixed 64 bit value from any 64 bit value - one step of
+ * splitmix64. Neighbouring inputs give unrelated outputs, so mix64(key + i)
+ * is a random number that depends only on the key and i, whichever thread
+ * asks for it and in whatever order.
+ **/
+inline std::uint64_t mix64(std::uint64_t z) {
+  z += 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * a small, fast random number generator for the hot loops of generators -
+ * splitmix64, which is a single add and @ref mix64 per number, against
+ * the 2.5KB of state std::mt19937 walks through. It meets the
+ * UniformRandomBitGenerator requirements so it works with std::shuffle
+ * and the <random> distributions.
+ *
+ * The generator is counter based: number i of a seed is mix64(seed + i *
+ * gamma) and doesn't depend on the numbers before it. It can therefore
+ * jump any distance ahead in one step, and a generator keyed by a cell,
+ * region or tile gives the same numbers whichever thread draws them.
+ * Generators take their numbers from here rather than std::mt19937 and
+ * %, whose results also differ between standard libraries.
+ **/
+class split_mix64 {
+  /// the counter the next number is mixed from
+  std::uint64_t _state;
+
+  /// the step between counters, the golden ratio scaled to 64 bits
+  static const std::uint64_t GAMMA = 0x9E3779B97F4A7C15ull;
+
+ public:
+  using result_type = std::uint64_t;
+
+  explicit split_mix64(std::uint64_t seed) : _state(seed) {}
+
+  /**
+   * @return a generator of its own for each id - a cell, region or tile
+   * say - under a key. Streams for different ids start at unrelated
+   * points of the sequence, so don't overlap in any run of realistic
+   * length.
+   **/
+  static split_mix64 stream(std::uint64_t key, std::uint64_t id) {
+    return split_mix64(key ^ mix64(id ^ mix64(key)));
+  }
+
+  static constexpr result_type min(void) { return 0; }
+  static constexpr result_type max(void) { return ~result_type(0); }
+
+  result_type operator()(void) {
+    result_type z = mix64(_state);
+    _state += GAMMA;
+    return z;
+  }
+
+  /**
+   * skips the next n numbers in constant time
+   **/
+  void discard(std::uint64_t n) { _state += n * GAMMA; }
+
+  /**
+   * @return a number from 0 to n - 1, where n > 0, every one equally
+   * likely. The high half of a 128 bit product of a random word and n is
+   * used rather than a division (Lemire's method); the few words that
+   * would favour some results over others are drawn again, and only then
+   * is the cost of a division paid to find out which they are.
+   **/
+  std::uint64_t below(std::uint64_t n) {
+    __extension__ typedef unsigned __int128 wide;
+    wide product = wide((*this)()) * n;
+    std::uint64_t low = std::uint64_t(product);
+    if (low < n) {
+      const std::uint64_t threshold = (0 - n) % n;
+      while (low < threshold) {
+        product = wide((*this)()) * n;
+        low = std::uint64_t(product);
+      }
+    }
+    return std::uint64_t(product >> 64);
+  }
+};
+
+/**
+ * shuffles a range into a uniformly random order - the Fisher-Yates
+ * shuffle, drawing from a @ref split_mix64 with @ref split_mix64::below.
+ * std::shuffle leaves the draws it makes to the standard library, so the
+ * same seed could give a different order - and maze - on another one.
+ **/
+template <class RandomIt>
+void shuffle(RandomIt first, RandomIt last, split_mix64& rnd) {
+  for (auto i = last - first; i > 1; --i) {
+    using std::swap;
+    swap(first[i - 1], first[rnd.below(std::uint64_t(i))]);
+  }
+}
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <vector>
+#include "arena.h"
+
+#pragma once
+/**
+ * @file ring_queue.h defines the first in, first out queue that breadth
+ * first searches hold their frontier in.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * a first in, first out queue held in a single ring buffer. The buffer is
+ * a power of two long so wrapping around is a mask rather than a
+ * division, and it doubles when it fills up, so a queue that is used
+ * again and again settles at the size it needs and then never allocates.
+ * Unlike a std::deque the elements are contiguous and no blocks are
+ * allocated or freed as the queue moves along.
+ **/
+template <class T>
+class ring_queue {
+  /// the buffer the elements live in - its size is a power of 2
+  arena_vector<T> _items;
+  /// the position of the oldest element
+  std::size_t _head;
+  /// the number of elements in the queue
+  std::size_t _size;
+
+  /// the size of the buffer of a new queue
+  static const std::size_t FIRST_SIZE = 64;
+
+  /**
+   * doubles the size of the buffer, moving the elements to its start
+   **/
+  void grow(void) {
+    arena_vector<T> bigger(_items.size() * 2, T(), _items.get_allocator());
+    for (std::size_t i = 0; i < _size; ++i) {
+      bigger[i] = _items[(_head + i) & (_items.size() - 1)];
+    }
+    _items.swap(bigger);
+    _head = 0;
+  }
+
+ public:
+  /**
+   * constructs an empty queue that uses the heap
+   **/
+  ring_queue(void) : _items(FIRST_SIZE), _head(0), _size(0) {}
+
+  /**
+   * constructs an empty queue whose elements live in an arena
+   **/
+  explicit ring_queue(arena& a)
+      : _items(FIRST_SIZE, T(), arena_allocator<T>(a)), _head(0), _size(0) {}
+
+  /**
+   * @return whether the queue has no elements
+   **/
+  bool empty(void) const { return _size == 0; }
+
+  /**
+   * @return the number of elements in the queue
+   **/
+  std::size_t size(void) const { return _size; }
+
+  /**
+   * removes every element, keeping the buffer
+   **/
+  void clear(void) { _head = _size = 0; }
+
+  /**
+   * adds an element at the back of the queue
+   **/
+  void push(T value) {
+    if (_size == _items.size()) grow();
+    _items[(_head + _size) & (_items.size() - 1)] = value;
+    ++_size;
+  }
+
+  /**
+   * @return the oldest element
+   **/
+  T front(void) const { return _items[_head]; }
+
+  /**
+   * removes and returns the oldest element. The queue must not be empty.
+   **/
+  T pop(void) {
+    T value = _items[_head];
+    _head = (_head + 1) & (_items.size() - 1);
+    --_size;
+    return value;
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
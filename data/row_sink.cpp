@@ -0,0 +1,179 @@
+#include "row_sink.h"
+#include <algorithm>
+#include <bitset>
+#include <iostream>
+
+namespace {
+/**
+ * @return whether bit x of a row's bit array is set
+ **/
+inline bool row_bit(const std::uint64_t* bits, int x) {
+  return (bits[x >> 6] >> (x & 63)) & 1;
+}
+}  // namespace
+
+/**
+ * @param width the width of the maze
+ * @param height the height of the maze
+ **/
+bool mazer2018::data::binary_row_sink::begin(int width, int height) {
+  _out.open(_name, std::ios::binary);
+  if (!_out) {
+    std::cerr << "Failed to open file " << _name << std::endl;
+    return false;
+  }
+  _out.exceptions(std::ios::badbit | std::ios::failbit);
+  _width = width;
+  std::copy(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC),
+            _header.magic);
+  _header.version = BINARY_VERSION;
+  _header.width = std::uint64_t(width);
+  _header.height = std::uint64_t(height);
+  _header.layout = std::uint32_t(layout_type::ROW_MAJOR);
+  _header.words =
+      2 * ((std::uint64_t(width) * std::uint64_t(height) + 63) / 64);
+  try {
+    _out.write((const char*)&_header, sizeof(_header));
+  } catch (const std::ios_base::failure& f) {
+    std::cerr << f.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void mazer2018::data::binary_row_sink::flush(void) {
+  _out.write((const char*)_words.data(),
+             std::streamsize(_words.size() * sizeof(std::uint64_t)));
+  _words.clear();
+}
+
+/**
+ * each word of the row is shifted in above the bits carried over from
+ * earlier rows. Whenever that fills a block the block is written out and
+ * the bits of the word that didn't fit are carried over instead.
+ **/
+bool mazer2018::data::binary_row_sink::row(const std::uint64_t* east,
+                                           const std::uint64_t* south) {
+  const std::size_t words = (std::size_t(_width) + 63) / 64;
+  try {
+    for (std::size_t i = 0; i < words; ++i) {
+      const int bits =
+          (i + 1 < words || _width % 64 == 0) ? 64 : _width % 64;
+      _edges += std::bitset<64>(east[i]).count() +
+                std::bitset<64>(south[i]).count();
+      _east_carry |= east[i] << _carry_bits;
+      _south_carry |= south[i] << _carry_bits;
+      if (_carry_bits + bits < 64) {
+        _carry_bits += bits;
+        continue;
+      }
+      _words.push_back(_east_carry);
+      _words.push_back(_south_carry);
+      const int used = 64 - _carry_bits;
+      _east_carry = used < 64 ? east[i] >> used : 0;
+      _south_carry = used < 64 ? south[i] >> used : 0;
+      _carry_bits += bits - 64;
+    }
+    flush();
+  } catch (const std::ios_base::failure& f) {
+    std::cerr << f.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * writes the last, partly filled block and then the header again now
+ * that the number of passages is known
+ **/
+bool mazer2018::data::binary_row_sink::finish(void) {
+  try {
+    if (_carry_bits > 0) {
+      _words.push_back(_east_carry);
+      _words.push_back(_south_carry);
+      flush();
+    }
+    _header.edges = _edges;
+    _out.seekp(0);
+    _out.write((const char*)&_header, sizeof(_header));
+    _out.close();
+  } catch (const std::ios_base::failure& f) {
+    std::cerr << f.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @param width the width of the maze
+ * @param height the height of the maze
+ **/
+bool mazer2018::data::svg_row_sink::begin(int width, int height) {
+  _out.open(_name);
+  if (!_out) {
+    std::cerr << "Failed to open file " << _name << std::endl;
+    return false;
+  }
+  _width = width;
+  _height = height;
+  _y = 0;
+  maze::save_svg_open(_out, width, height);
+  return _out.good();
+}
+
+bool mazer2018::data::svg_row_sink::row(const std::uint64_t* east,
+                                        const std::uint64_t* south) {
+  // passages are written in the same order as maze::save_svg_func
+  for (int x = 0; x < _width; ++x) {
+    if (row_bit(south, x)) {
+      edge e(x, _y, x, _y + 1);
+      maze::save_svg_edge(&e, _out);
+    }
+    if (row_bit(east, x)) {
+      edge e(x, _y, x + 1, _y);
+      maze::save_svg_edge(&e, _out);
+    }
+  }
+  ++_y;
+  if (!_out) {
+    std::cerr << "There was an error writing the svg file " << _name
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool mazer2018::data::svg_row_sink::finish(void) {
+  maze::save_svg_close(_out, _width, _height, false);
+  _out.close();
+  if (!_out) {
+    std::cerr << "There was an error writing the svg file " << _name
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @param width the width of the maze
+ * @param height the height of the maze
+ **/
+bool mazer2018::data::maze_row_sink::begin(int width, int height) {
+  _maze.height(height);
+  _maze.width(width);
+  _maze.init();
+  _y = 0;
+  return true;
+}
+
+bool mazer2018::data::maze_row_sink::row(const std::uint64_t* east,
+                                         const std::uint64_t* south) {
+  _maze.open_row(_y++, east, south);
+  return true;
+}
+
+bool mazer2018::data::maze_row_sink::finish(void) {
+  // a maze generated into a file is complete once its header is written
+  _maze.sync();
+  return true;
+}
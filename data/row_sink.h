@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "maze.h"
+
+#pragma once
+/**
+ * @file row_sink.h defines the destinations a maze can be streamed into a
+ * row at a time, so that a maze too big to hold in memory can still be
+ * generated and saved.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * receives the passages of a maze one row at a time from the top. A row
+ * is passed as two bit arrays of (width + 63) / 64 words - bit x % 64 of
+ * word x / 64 is set for a passage from the cell in column x to its east
+ * or south. The east bit of the last column and the south bits of the
+ * last row are never set.
+ *
+ * Failures are reported on std::cerr and by returning false, after which
+ * nothing more is passed to the sink.
+ **/
+class row_sink {
+ public:
+  virtual ~row_sink(void) {}
+
+  /**
+   * starts a maze of the size specified
+   **/
+  virtual bool begin(int width, int height) = 0;
+
+  /**
+   * takes the passages of the next row
+   **/
+  virtual bool row(const std::uint64_t* east, const std::uint64_t* south) = 0;
+
+  /**
+   * completes the maze once every row has been passed
+   **/
+  virtual bool finish(void) = 0;
+};
+
+/**
+ * writes a version 2 binary maze file in the row-major layout - the same
+ * file @ref maze::save_binary writes for a row-major maze. Rows rarely
+ * line up with the 64 cell blocks of the file so up to one block of each
+ * row is carried over to the next; nothing else is held.
+ **/
+class binary_row_sink : public row_sink {
+  /// the name of the file to write
+  std::string _name;
+  /// the file being written
+  std::ofstream _out;
+  /// the width of the maze
+  int _width;
+  /// the number of passages written so far
+  std::uint64_t _edges;
+  /// the east and south bits of the block being filled
+  std::uint64_t _east_carry, _south_carry;
+  /// the number of cells in the block being filled
+  int _carry_bits;
+  /// the words of the blocks completed by the current row
+  std::vector<std::uint64_t> _words;
+  /// the header, which is written again at the end with the number of
+  /// passages
+  binary_header _header;
+
+  /**
+   * writes the words of the blocks completed so far
+   **/
+  void flush(void);
+
+ public:
+  explicit binary_row_sink(const std::string& name)
+      : _name(name),
+        _width(0),
+        _edges(0),
+        _east_carry(0),
+        _south_carry(0),
+        _carry_bits(0),
+        _header() {}
+
+  virtual bool begin(int width, int height);
+  virtual bool row(const std::uint64_t* east, const std::uint64_t* south);
+  virtual bool finish(void);
+};
+
+/**
+ * writes an svg file in the same form as @ref maze::save_svg_func, one
+ * row of passages at a time
+ **/
+class svg_row_sink : public row_sink {
+  /// the name of the file to write
+  std::string _name;
+  /// the file being written
+  std::ofstream _out;
+  /// the size of the maze
+  int _width, _height;
+  /// the row about to be written
+  int _y;
+
+ public:
+  explicit svg_row_sink(const std::string& name)
+      : _name(name), _width(0), _height(0), _y(0) {}
+
+  virtual bool begin(int width, int height);
+  virtual bool row(const std::uint64_t* east, const std::uint64_t* south);
+  virtual bool finish(void);
+};
+
+/**
+ * opens the passages of each row in a @ref maze, in whatever layout and
+ * storage the maze has - a memory mapped file included.
+ **/
+class maze_row_sink : public row_sink {
+  /// the maze to fill in
+  maze& _maze;
+  /// the row about to be filled in
+  int _y;
+
+ public:
+  explicit maze_row_sink(maze& m) : _maze(m), _y(0) {}
+
+  virtual bool begin(int width, int height);
+  virtual bool row(const std::uint64_t* east, const std::uint64_t* south);
+  virtual bool finish(void);
+};
+
+/**
+ * passes a maze of the size specified to each of the sinks a row at a
+ * time. next_row(y) is called to work the passages of row y out into east
+ * and south, which are then passed to every sink before the next row.
+ * @return false if any sink failed
+ **/
+template <class F>
+bool stream_rows(int width, int height, const std::vector<row_sink*>& sinks,
+                 const std::uint64_t* east, const std::uint64_t* south,
+                 F next_row) {
+  for (row_sink* sink : sinks) {
+    if (!sink->begin(width, height)) return false;
+  }
+  for (int y = 0; y < height; ++y) {
+    next_row(y);
+    for (row_sink* sink : sinks) {
+      if (!sink->row(east, south)) return false;
+    }
+  }
+  for (row_sink* sink : sinks) {
+    if (!sink->finish()) return false;
+  }
+  return true;
+}
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "arena.h"
+
+#pragma once
+/**
+ * @file sparse_array.h defines an array that only holds memory for the
+ * parts of it that have been written to.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * a huge array of T, every element of which starts as zero, that is
+ * stored as chunks of 2^SHIFT elements. A chunk is only allocated when an
+ * element in it is first written, so the memory used follows the parts of
+ * the array that are in use rather than its length.
+ *
+ * The chunks are found through an open addressing hash table keyed by
+ * chunk number with linear probing, and the most recently used chunk is
+ * cached since walks over a maze tend to stay in one place. The chunks
+ * themselves come from an @ref arena and are all freed together by
+ * @ref clear.
+ **/
+template <class T, int SHIFT>
+class sparse_array {
+ public:
+  /// the number of elements in each chunk
+  static const std::size_t CHUNK = std::size_t(1) << SHIFT;
+
+ private:
+  /// an entry in the chunk index
+  struct slot {
+    /// the chunk number or @ref EMPTY
+    std::uint64_t key;
+    /// the elements of the chunk
+    T* chunk;
+  };
+
+  /// the key of an unused slot
+  static const std::uint64_t EMPTY = ~std::uint64_t(0);
+  /// the number of slots in a new index
+  static const int FIRST_BITS = 4;
+
+  /// where the chunks are allocated
+  std::unique_ptr<arena> _arena;
+  /// the chunk index - its size is always a power of 2
+  std::vector<slot> _slots;
+  /// log2 of the size of the index
+  int _bits;
+  /// the number of chunks allocated
+  std::size_t _chunks;
+  /// the most recently looked up chunk number and its chunk, which is
+  /// nullptr if it has not been allocated
+  mutable std::uint64_t _last_key;
+  mutable T* _last_chunk;
+
+  /**
+   * @return the slot that holds a chunk number or the empty slot where it
+   * would go
+   **/
+  std::size_t probe(std::uint64_t key) const {
+    // fibonacci hashing spreads neighbouring chunk numbers over the index
+    std::size_t i =
+        std::size_t((key * 0x9E3779B97F4A7C15ull) >> (64 - _bits));
+    const std::size_t mask = _slots.size() - 1;
+    while (_slots[i].key != key && _slots[i].key != EMPTY) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  /**
+   * doubles the size of the index, keeping it at most half full
+   **/
+  void grow(void) {
+    std::vector<slot> old;
+    old.swap(_slots);
+    ++_bits;
+    _slots.assign(std::size_t(1) << _bits, slot{EMPTY, nullptr});
+    for (const slot& s : old) {
+      if (s.key != EMPTY) _slots[probe(s.key)] = s;
+    }
+  }
+
+ public:
+  /**
+   * constructs an array in which every element is zero
+   **/
+  sparse_array(void) : _chunks(0) { clear(); }
+
+  /**
+   * @return the chunk with the number specified or nullptr if nothing in
+   * it has been written
+   **/
+  const T* find(std::uint64_t key) const {
+    if (key != _last_key) {
+      _last_key = key;
+      _last_chunk = _slots[probe(key)].chunk;
+    }
+    return _last_chunk;
+  }
+
+  /**
+   * @return the chunk with the number specified, allocating it full of
+   * zeros if it doesn't exist yet
+   **/
+  T* chunk(std::uint64_t key) {
+    if (key == _last_key && _last_chunk) return _last_chunk;
+    std::size_t i = probe(key);
+    if (_slots[i].key == EMPTY) {
+      if (2 * (_chunks + 1) > _slots.size()) {
+        grow();
+        i = probe(key);
+      }
+      T* chunk = static_cast<T*>(_arena->allocate(CHUNK * sizeof(T)));
+      std::fill(chunk, chunk + CHUNK, T());
+      _slots[i] = slot{key, chunk};
+      ++_chunks;
+    }
+    _last_key = key;
+    _last_chunk = _slots[i].chunk;
+    return _last_chunk;
+  }
+
+  /**
+   * @return the element at index i
+   **/
+  T get(std::size_t i) const {
+    const T* c = find(i >> SHIFT);
+    return c ? c[i & (CHUNK - 1)] : T();
+  }
+
+  /**
+   * @return a reference to the element at index i, allocating its chunk
+   * if need be
+   **/
+  T& touch(std::size_t i) { return chunk(i >> SHIFT)[i & (CHUNK - 1)]; }
+
+  /**
+   * sets every element back to zero and frees every chunk
+   **/
+  void clear(void) {
+    _arena.reset(new arena());
+    _bits = FIRST_BITS;
+    _slots.assign(std::size_t(1) << _bits, slot{EMPTY, nullptr});
+    _chunks = 0;
+    _last_key = EMPTY;
+    _last_chunk = nullptr;
+  }
+
+  /// @return the number of chunks that have been allocated
+  std::size_t chunks(void) const { return _chunks; }
+
+  /**
+   * @return the number of bytes held by the chunks and the index
+   **/
+  std::size_t bytes(void) const {
+    return _chunks * CHUNK * sizeof(T) + _slots.size() * sizeof(slot);
+  }
+
+  /**
+   * calls f(key, chunk) for every chunk that has been allocated, in no
+   * particular order
+   **/
+  template <class F>
+  void for_each_chunk(F f) const {
+    for (const slot& s : _slots) {
+      if (s.key != EMPTY) f(std::size_t(s.key), static_cast<const T*>(s.chunk));
+    }
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
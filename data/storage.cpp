@@ -0,0 +1,290 @@
+#include "storage.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "../args/action.h"
+#if defined(__unix__) || defined(__APPLE__)
+#define MAZER_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @param words the number of words the grid needs
+ **/
+std::uint64_t* mazer2018::data::heap_storage::allocate(std::size_t words) {
+  _words.assign(words, 0);
+  return _words.data();
+}
+
+/**
+ * @param words the number of words the grid needs
+ **/
+std::uint64_t* mazer2018::data::sparse_storage::allocate(std::size_t words) {
+  _words.clear();
+  _size = words;
+  return nullptr;
+}
+
+/**
+ * @param source works out the words of each tile
+ * @param words the number of words in the grid
+ * @param tiles the most tiles to hold at once
+ **/
+mazer2018::data::tile_storage::tile_storage(
+    std::unique_ptr<tile_source> source, std::size_t words,
+    std::size_t tiles)
+    : _source(std::move(source)), _capacity(std::max<std::size_t>(tiles, 1)) {
+  _words.resize(_capacity * TILE_WORDS);
+  _entries.reserve(_capacity);
+  _index.reserve(_capacity);
+  allocate(words);
+}
+
+/**
+ * nothing is worked out here - the grid is as big as asked for from the
+ * start, and any tiles held are dropped
+ * @param words the number of words in the grid
+ **/
+std::uint64_t* mazer2018::data::tile_storage::allocate(std::size_t words) {
+  _size = words;
+  _entries.clear();
+  _index.clear();
+  _newest = _oldest = NONE;
+  _last_key = NONE;
+  _last_tile = nullptr;
+  _filled = 0;
+  return nullptr;
+}
+
+/**
+ * @param i the entry to move
+ **/
+void mazer2018::data::tile_storage::use(std::size_t i) const {
+  if (i == _newest) return;
+  entry& e = _entries[i];
+  // unlink it - it isn't the newest so there is one newer
+  _entries[e.newer].older = e.older;
+  if (e.older != NONE) {
+    _entries[e.older].newer = e.newer;
+  } else {
+    _oldest = e.newer;
+  }
+  e.newer = NONE;
+  e.older = _newest;
+  _entries[_newest].newer = i;
+  _newest = i;
+}
+
+/**
+ * once the cache is full the least recently used tile is dropped to make
+ * room for each tile that isn't held
+ * @param key the number of the tile
+ **/
+const std::uint64_t* mazer2018::data::tile_storage::find(
+    std::uint64_t key) const {
+  auto found = _index.find(key);
+  if (found != _index.end()) {
+    use(found->second);
+    return &_words[found->second * TILE_WORDS];
+  }
+  std::size_t i;
+  if (_entries.size() < _capacity) {
+    i = _entries.size();
+    _entries.push_back(entry{key, NONE, _newest});
+    if (_newest != NONE) {
+      _entries[_newest].newer = i;
+    } else {
+      _oldest = i;
+    }
+    _newest = i;
+  } else {
+    i = _oldest;
+    _index.erase(_entries[i].key);
+    _entries[i].key = key;
+    use(i);
+  }
+  _index.emplace(key, i);
+  std::uint64_t* words = &_words[i * TILE_WORDS];
+  _source->fill(key, words);
+  ++_filled;
+  return words;
+}
+
+mazer2018::data::mapped_storage::mapped_storage(const std::string& name,
+                                                bool read_only)
+    : _name(name),
+      _fd(-1),
+      _base(nullptr),
+      _length(0),
+      _read_only(read_only) {}
+
+mazer2018::data::mapped_storage::~mapped_storage(void) {
+  flush();
+  unmap();
+#ifdef MAZER_HAVE_MMAP
+  if (_fd >= 0) close(_fd);
+#endif
+}
+
+bool mazer2018::data::mapped_storage::supported(void) {
+#ifdef MAZER_HAVE_MMAP
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @param length the number of bytes of the file to map
+ **/
+void mazer2018::data::mapped_storage::map(std::size_t length) {
+#ifdef MAZER_HAVE_MMAP
+  int prot = _read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+  void* base = mmap(nullptr, length, prot, MAP_SHARED, _fd, 0);
+  if (base == MAP_FAILED) {
+    std::ostringstream oss;
+    oss << "Error: could not map " << _name << ": " << std::strerror(errno)
+        << std::endl;
+    throw args::action_failed(oss.str());
+  }
+  _base = base;
+  _length = length;
+#endif
+}
+
+void mazer2018::data::mapped_storage::unmap(void) {
+#ifdef MAZER_HAVE_MMAP
+  if (_base) munmap(_base, _length);
+#endif
+  _base = nullptr;
+  _length = 0;
+}
+
+/**
+ * @param name the name of the file to create
+ **/
+std::unique_ptr<mazer2018::data::mapped_storage>
+mazer2018::data::mapped_storage::create(const std::string& name) {
+#ifdef MAZER_HAVE_MMAP
+  std::unique_ptr<mapped_storage> storage(new mapped_storage(name, false));
+  storage->_fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (storage->_fd < 0) {
+    std::ostringstream oss;
+    oss << "Error: could not create the maze file " << name << ": "
+        << std::strerror(errno) << std::endl;
+    throw args::action_failed(oss.str());
+  }
+  // start with an empty grid so the file is a valid maze file from the
+  // outset
+  storage->allocate(0);
+  return storage;
+#else
+  throw args::action_failed(
+      "Error: memory mapped mazes are not supported on this platform");
+#endif
+}
+
+/**
+ * @param name the name of the maze file to map
+ **/
+std::unique_ptr<mazer2018::data::mapped_storage>
+mazer2018::data::mapped_storage::open(const std::string& name) {
+#ifdef MAZER_HAVE_MMAP
+  std::unique_ptr<mapped_storage> storage(new mapped_storage(name, true));
+  storage->_fd = ::open(name.c_str(), O_RDONLY);
+  struct stat info;
+  if (storage->_fd < 0 || fstat(storage->_fd, &info) != 0) {
+    std::cerr << "Error: could not open " << name << ": "
+              << std::strerror(errno) << std::endl;
+    return nullptr;
+  }
+  std::size_t length = std::size_t(info.st_size);
+  if (length < sizeof(binary_header)) {
+    std::cerr << "Error: the binary file is too short to hold a maze."
+              << std::endl;
+    return nullptr;
+  }
+  try {
+    storage->map(length);
+  } catch (args::action_failed& af) {
+    std::cerr << af.what();
+    return nullptr;
+  }
+  const binary_header* header = storage->header();
+  if (!std::equal(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC),
+                  header->magic) ||
+      header->version != BINARY_VERSION) {
+    std::cerr << "Error: " << name << " is not a version " << BINARY_VERSION
+              << " binary maze file." << std::endl;
+    return nullptr;
+  }
+  if (header->words != (length - sizeof(binary_header)) / sizeof(std::uint64_t) ||
+      (length - sizeof(binary_header)) % sizeof(std::uint64_t) != 0) {
+    std::cerr << "Error: the binary file is truncated." << std::endl;
+    return nullptr;
+  }
+  return storage;
+#else
+  std::cerr << "Error: memory mapped mazes are not supported on this "
+            << "platform." << std::endl;
+  return nullptr;
+#endif
+}
+
+/**
+ * the file is resized to hold the header and the words and mapped again.
+ * @param words the number of words the grid needs
+ **/
+std::uint64_t* mazer2018::data::mapped_storage::allocate(std::size_t words) {
+  if (_read_only) {
+    throw args::action_failed("Error: " + _name + " is mapped read-only");
+  }
+#ifdef MAZER_HAVE_MMAP
+  unmap();
+  std::size_t length = sizeof(binary_header) + words * sizeof(std::uint64_t);
+  // shrinking the file to nothing first discards the old contents so that
+  // every word reads back as zero
+  if (ftruncate(_fd, 0) != 0 || ftruncate(_fd, off_t(length)) != 0) {
+    std::ostringstream oss;
+    oss << "Error: could not resize " << _name << ": "
+        << std::strerror(errno) << std::endl;
+    throw args::action_failed(oss.str());
+  }
+  map(length);
+  binary_header* head = header();
+  std::copy(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC), head->magic);
+  head->version = BINARY_VERSION;
+  head->words = words;
+#endif
+  return data();
+}
+
+std::uint64_t* mazer2018::data::mapped_storage::data(void) {
+  if (!_base) return nullptr;
+  return reinterpret_cast<std::uint64_t*>(static_cast<char*>(_base) +
+                                          sizeof(binary_header));
+}
+
+std::size_t mazer2018::data::mapped_storage::size(void) const {
+  if (!_base) return 0;
+  return (_length - sizeof(binary_header)) / sizeof(std::uint64_t);
+}
+
+mazer2018::data::binary_header* mazer2018::data::mapped_storage::header(
+    void) {
+  return static_cast<binary_header*>(_base);
+}
+
+/**
+ * the mapping is shared so other processes already see every change;
+ * this only asks the kernel to start writing the dirty pages back.
+ **/
+void mazer2018::data::mapped_storage::flush(void) {
+#ifdef MAZER_HAVE_MMAP
+  if (_base && !_read_only) msync(_base, _length, MS_ASYNC);
+#endif
+}
@@ -0,0 +1,362 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sparse_array.h"
+
+#pragma once
+/**
+ * @file storage.h defines where the words of a @ref wall_grid live: on the
+ * heap, in a memory mapped maze file or in chunks allocated on demand.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * the header at the start of a version 2 binary maze file. The header is
+ * followed immediately by the words of the maze's @ref wall_grid, so the
+ * file is as compact as the maze is in memory and can describe a maze
+ * whose edge count does not fit in 32 bits. All values are written in the
+ * byte order of the machine (little endian on every platform we build
+ * on).
+ *
+ * Because the words follow a 64 byte header they are aligned in the file,
+ * so a maze file can be mapped into memory and used in place.
+ *
+ * Version 1 files - the original format of a width, height and edge count
+ * followed by four ints per edge - can still be loaded.
+ **/
+struct binary_header {
+  /// always @ref BINARY_MAGIC
+  char magic[4];
+  /// the version of the file format, currently 2
+  std::uint32_t version;
+  /// the width of the maze
+  std::uint64_t width,
+      /// the height of the maze
+      height,
+      /// the number of passages in the maze
+      edges;
+  /// the @ref layout_type of the grid words that follow
+  std::uint32_t layout,
+      /// unused - always 0
+      reserved;
+  /// the number of grid words that follow the header
+  std::uint64_t words;
+  /// unused - pads the header to 64 bytes so the words are aligned
+  std::uint64_t padding[2];
+};
+
+/**
+ * the magic number at the start of a version 2 binary maze file. As an int
+ * it is far larger than any valid width so it can't be mistaken for the
+ * start of a version 1 file.
+ **/
+const char BINARY_MAGIC[4] = {'M', 'A', 'Z', '2'};
+
+/**
+ * the current version of the binary file format
+ **/
+const std::uint32_t BINARY_VERSION = 2;
+
+/**
+ * the words of a sparse grid. A chunk of 128 words holds 4096 cells, which
+ * is a single 64x64 tile in the tiled64 and morton layouts.
+ **/
+using sparse_words = sparse_array<std::uint64_t, 7>;
+
+class tile_storage;
+
+/**
+ * the backing store for the words of a @ref wall_grid. Most storage holds
+ * a contiguous run of words that the grid reads and writes directly, so
+ * generators and solvers run unchanged whichever storage is used; sparse
+ * storage instead holds its words in chunks - see @ref sparse.
+ **/
+class grid_storage {
+ public:
+  virtual ~grid_storage(void) {}
+
+  /**
+   * discards the current contents and provides room for the number of
+   * words specified, all of them zero.
+   * @return the first of the words, or nullptr for sparse storage
+   **/
+  virtual std::uint64_t* allocate(std::size_t words) = 0;
+
+  /**
+   * @return the words currently held, or nullptr if nothing has been
+   * allocated
+   **/
+  virtual std::uint64_t* data(void) = 0;
+
+  /**
+   * @return the number of words currently held
+   **/
+  virtual std::size_t size(void) const = 0;
+
+  /**
+   * @return whether the words may only be read. A grid over read-only
+   * storage moves to the heap when it is resized.
+   **/
+  virtual bool read_only(void) const { return false; }
+
+  /**
+   * @return the file header in front of the words when the storage is a
+   * maze file, or nullptr otherwise
+   **/
+  virtual binary_header* header(void) { return nullptr; }
+
+  /**
+   * @return whether the words are held in a memory mapped file
+   **/
+  virtual bool mapped(void) const { return false; }
+
+  /**
+   * @return the chunks that hold the words when the storage is sparse, or
+   * nullptr if the words are contiguous
+   **/
+  virtual sparse_words* sparse(void) { return nullptr; }
+
+  /**
+   * @return this storage when its words are worked out a tile at a time
+   * as they are read, or nullptr if they are held
+   **/
+  virtual tile_storage* tiles(void) { return nullptr; }
+
+  /**
+   * writes any changes through to the backing file, if there is one
+   **/
+  virtual void flush(void) {}
+};
+
+/**
+ * the default storage - a vector on the heap
+ **/
+class heap_storage : public grid_storage {
+  /// the words of the grid
+  std::vector<std::uint64_t> _words;
+
+ public:
+  virtual std::uint64_t* allocate(std::size_t words);
+  virtual std::uint64_t* data(void) { return _words.data(); }
+  virtual std::size_t size(void) const { return _words.size(); }
+};
+
+/**
+ * storage for a grid in which few cells are in use, such as a maze cut out
+ * of a mask. The words are held in chunks that are only allocated when a
+ * passage in them is opened, so the memory needed follows the cells in use
+ * rather than the size of the grid.
+ **/
+class sparse_storage : public grid_storage {
+  /// the words of the grid
+  sparse_words _words;
+  /// the number of words in the grid
+  std::size_t _size;
+
+ public:
+  sparse_storage(void) : _size(0) {}
+  virtual std::uint64_t* allocate(std::size_t words);
+  virtual std::uint64_t* data(void) { return nullptr; }
+  virtual std::size_t size(void) const { return _size; }
+  virtual sparse_words* sparse(void) { return &_words; }
+};
+
+/**
+ * storage that is a memory mapping of a version 2 maze file. The words of
+ * the grid are the words of the file, so a generator writes straight into
+ * the page cache, the operating system can page cold parts of a huge maze
+ * out and loading the file is nothing more than mapping it.
+ *
+ * A writable mapping creates (or truncates) the file and is shared, so
+ * the file always holds the maze; @ref flush asks for the changed pages
+ * to be written back. A read-only mapping is also shared, so any number of
+ * processes can query one maze file while holding a single copy of it in
+ * memory.
+ *
+ * Mappings are only available on POSIX systems - see @ref supported.
+ **/
+class mapped_storage : public grid_storage {
+  /// the name of the mapped file
+  std::string _name;
+  /// the file descriptor of the mapped file or -1
+  int _fd;
+  /// the start of the mapping - the file header
+  void* _base;
+  /// the number of bytes mapped
+  std::size_t _length;
+  /// whether the mapping is read-only
+  bool _read_only;
+
+  /**
+   * maps the first length bytes of the open file
+   **/
+  void map(std::size_t length);
+
+  /**
+   * releases the current mapping, if any
+   **/
+  void unmap(void);
+
+  mapped_storage(const std::string& name, bool read_only);
+
+ public:
+  mapped_storage(const mapped_storage&) = delete;
+  mapped_storage& operator=(const mapped_storage&) = delete;
+  virtual ~mapped_storage(void);
+
+  /**
+   * @return whether memory mapped files are available on this platform
+   **/
+  static bool supported(void);
+
+  /**
+   * creates a maze file, or truncates an existing one, for a grid to be
+   * written into. The file holds no words until the grid is allocated.
+   * @throw args::action_failed if the file could not be created
+   **/
+  static std::unique_ptr<mapped_storage> create(const std::string& name);
+
+  /**
+   * maps an existing version 2 maze file read-only. Only the header is
+   * checked - it must describe the number of words the file holds.
+   * @return the mapping or nullptr if the file could not be mapped, in
+   * which case the reason has been written to std::cerr
+   **/
+  static std::unique_ptr<mapped_storage> open(const std::string& name);
+
+  virtual std::uint64_t* allocate(std::size_t words);
+  virtual std::uint64_t* data(void);
+  virtual std::size_t size(void) const;
+  virtual bool read_only(void) const { return _read_only; }
+  virtual binary_header* header(void);
+  virtual bool mapped(void) const { return true; }
+  virtual void flush(void);
+
+  /**
+   * @return the name of the mapped file
+   **/
+  const std::string& name(void) const { return _name; }
+};
+
+/**
+ * works out the words of a @ref tile_storage one tile at a time
+ **/
+class tile_source {
+ public:
+  virtual ~tile_source(void) {}
+
+  /**
+   * fills in the words of a tile - words tile * @ref
+   * tile_storage::TILE_WORDS onwards of the grid. They must depend on
+   * nothing but the tile, as a tile is worked out again each time it is
+   * read after being dropped from the cache.
+   **/
+  virtual void fill(std::uint64_t tile, std::uint64_t* words) const = 0;
+};
+
+/**
+ * read-only storage for a grid that is never held in full. Its words are
+ * worked out by a @ref tile_source the first time a tile of them is read
+ * and kept in a cache of a fixed number of tiles, the least recently used
+ * of which makes way for the next. Memory is bounded by the size of the
+ * cache however big the grid is, and nothing is worked out until it is
+ * read, so a grid of any size is ready at once.
+ *
+ * A tile is as many words as a chunk of @ref sparse_words - a 64x64 tile
+ * of cells in the tiled64 layout. The cache is not safe to read from more
+ * than one thread at a time.
+ **/
+class tile_storage : public grid_storage {
+ public:
+  /// log2 of @ref TILE_WORDS
+  static const int TILE_SHIFT = 7;
+  /// the number of words in each tile
+  static const std::size_t TILE_WORDS = std::size_t(1) << TILE_SHIFT;
+
+ private:
+  /// a tile held in the cache, linked into a list from most to least
+  /// recently used
+  struct entry {
+    /// the number of the tile
+    std::uint64_t key;
+    /// the entries used just before and just after this one, or @ref NONE
+    std::size_t newer, older;
+  };
+  /// the end of the list of entries
+  static const std::size_t NONE = ~std::size_t(0);
+
+  /// works out the words of each tile
+  std::unique_ptr<tile_source> _source;
+  /// the number of words in the grid
+  std::size_t _size;
+  /// the most tiles held at once
+  std::size_t _capacity;
+  /// the words of the tiles held - TILE_WORDS for each entry
+  mutable std::vector<std::uint64_t> _words;
+  /// the tiles held
+  mutable std::vector<entry> _entries;
+  /// the entry of each tile held
+  mutable std::unordered_map<std::uint64_t, std::size_t> _index;
+  /// the most and least recently used entries
+  mutable std::size_t _newest, _oldest;
+  /// the number of the tile read last, or @ref NONE, and its words
+  mutable std::uint64_t _last_key;
+  mutable const std::uint64_t* _last_tile;
+  /// the number of tiles worked out so far
+  mutable std::size_t _filled;
+
+  /**
+   * moves an entry to the front of the list of entries
+   **/
+  void use(std::size_t) const;
+
+  /**
+   * @return the words of a tile, working it out if it is not held
+   **/
+  const std::uint64_t* find(std::uint64_t key) const;
+
+ public:
+  /**
+   * @param source works out the words of each tile
+   * @param words the number of words in the grid
+   * @param tiles the most tiles to hold at once - at least one
+   **/
+  tile_storage(std::unique_ptr<tile_source> source, std::size_t words,
+               std::size_t tiles);
+
+  /**
+   * @return the word at index i
+   **/
+  std::uint64_t get(std::size_t i) const {
+    const std::uint64_t key = i >> TILE_SHIFT;
+    if (key != _last_key) {
+      _last_tile = find(key);
+      _last_key = key;
+    }
+    return _last_tile[i & (TILE_WORDS - 1)];
+  }
+
+  /**
+   * @return the number of tiles worked out so far, counting each time a
+   * tile is worked out again
+   **/
+  std::size_t filled(void) const { return _filled; }
+
+  /**
+   * @return the number of bytes the cache holds at most
+   **/
+  std::size_t bytes(void) const {
+    return _capacity * (TILE_WORDS * sizeof(std::uint64_t) + sizeof(entry));
+  }
+
+  virtual std::uint64_t* allocate(std::size_t words);
+  virtual std::uint64_t* data(void) { return nullptr; }
+  virtual std::size_t size(void) const { return _size; }
+  virtual bool read_only(void) const { return true; }
+  virtual tile_storage* tiles(void) { return this; }
+};
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,42 @@
+#include "traversal.h"
+#include <algorithm>
+
+/**
+ * @param cells the number of cells in the maze about to be walked
+ **/
+void mazer2018::data::traversal_context::reset(std::size_t cells) {
+  _root = constants::ERROR;
+  if (_sparse) {
+    _sparse = false;
+    _sparse_marks.clear();
+  }
+  // a different sized maze needs a fresh array - every mark is zero so
+  // nothing is visited in epoch 1
+  if (_marks.size() != cells) {
+    _marks.assign(cells, 0);
+    _epoch = 1;
+    return;
+  }
+  // otherwise moving to the next epoch invalidates every mark. If the
+  // counter wraps we have to clear the marks for real.
+  if (++_epoch > MAX_EPOCH) {
+    std::fill(_marks.begin(), _marks.end(), 0);
+    _epoch = 1;
+  }
+}
+
+void mazer2018::data::traversal_context::reset_sparse(void) {
+  _root = constants::ERROR;
+  // the dense marks are no longer needed so give their memory back
+  if (!_sparse) {
+    arena_vector<std::uint8_t>(_marks.get_allocator()).swap(_marks);
+    _sparse = true;
+    _sparse_marks.clear();
+    _epoch = 1;
+    return;
+  }
+  if (++_epoch > MAX_EPOCH) {
+    _sparse_marks.clear();
+    _epoch = 1;
+  }
+}
@@ -0,0 +1,147 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+#include "maze.h"
+#include "sparse_array.h"
+
+#pragma once
+/**
+ * @file traversal.h defines the scratch state that generators and solvers
+ * keep while they walk a maze.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * the per cell state of a walk over a maze: whether each cell has been
+ * visited and the direction of the cell it was reached from. Keeping this
+ * out of the maze means the maze is never written to while it is being
+ * read and the same context can be reused across many walks.
+ *
+ * Instead of clearing a visited flag for every cell, each cell is stamped
+ * with the epoch in which it was visited. Starting a new walk just moves
+ * to the next epoch so a reset is O(1); the stamps only need clearing
+ * when the epoch counter wraps around.
+ *
+ * The stamp and the parent direction share a single byte per cell - the
+ * top 6 bits hold the epoch and the bottom 2 bits the direction - so a
+ * walk over a ten billion cell maze needs 10GB rather than 50GB.
+ *
+ * A walk over a sparse maze keeps its marks in a @ref sparse_array
+ * instead, so its memory follows the cells visited.
+ **/
+class traversal_context {
+  /// the epoch in which each cell was last visited and the direction
+  /// back to its parent, indexed by handle
+  arena_vector<std::uint8_t> _marks;
+  /// the marks of a walk over a sparse maze, one 64x64 tile to a chunk in
+  /// the tiled layouts
+  sparse_array<std::uint8_t, 12> _sparse_marks;
+  /// whether the marks are held in @ref _sparse_marks
+  bool _sparse;
+  /// the cell the current walk started from, which has no parent
+  cell_id _root;
+  /// the epoch of the current walk. Never 0 so that a freshly allocated
+  /// mark is never mistaken for a visit.
+  std::uint8_t _epoch;
+
+  /// the number of bits of a mark that hold the parent direction
+  static const int DIR_BITS = 2;
+  /// the largest epoch that fits in a mark
+  static const std::uint8_t MAX_EPOCH = 0xff >> DIR_BITS;
+
+  /**
+   * @return the mark of a cell
+   **/
+  std::uint8_t mark(cell_id id) const {
+    return _sparse ? _sparse_marks.get(std::size_t(id)) : _marks[id];
+  }
+
+  /**
+   * @return a reference to the mark of a cell
+   **/
+  std::uint8_t& mark(cell_id id) {
+    return _sparse ? _sparse_marks.touch(std::size_t(id)) : _marks[id];
+  }
+
+ public:
+  /**
+   * default constructor - a context for an empty maze
+   **/
+  traversal_context(void)
+      : _sparse(false), _root(constants::ERROR), _epoch(1) {}
+
+  /**
+   * constructs a context whose marks are allocated from an arena
+   **/
+  explicit traversal_context(arena& a)
+      : _marks(a), _sparse(false), _root(constants::ERROR), _epoch(1) {}
+
+  /**
+   * @return the allocator the marks come from, so that scratch containers
+   * used alongside the context can share its arena
+   **/
+  arena_allocator<std::uint8_t> get_allocator(void) const {
+    return _marks.get_allocator();
+  }
+
+  /**
+   * starts a new walk over a maze with the specified number of cells.
+   * Afterwards no cell is visited.
+   **/
+  void reset(std::size_t cells);
+
+  /**
+   * starts a new walk over a sparse maze. Afterwards no cell is visited.
+   **/
+  void reset_sparse(void);
+
+  /**
+   * starts a new walk over the maze specified
+   **/
+  void reset(const maze& m) {
+    // a procedural maze may be far too big for a mark per cell
+    if (m.sparse() || m.procedural()) {
+      reset_sparse();
+    } else {
+      reset(std::size_t(m.capacity()));
+    }
+  }
+
+  /**
+   * @return whether a cell has been visited in the current walk
+   **/
+  bool visited(cell_id id) const {
+    return (mark(id) >> DIR_BITS) == _epoch;
+  }
+
+  /**
+   * marks a cell as visited with no parent - the start of a walk
+   **/
+  void visit(cell_id id) {
+    _root = id;
+    mark(id) = std::uint8_t(_epoch << DIR_BITS);
+  }
+
+  /**
+   * marks a cell as visited
+   * @param id the cell being visited
+   * @param parent the direction from this cell back to the cell it was
+   * reached from
+   **/
+  void visit(cell_id id, direction parent) {
+    mark(id) = std::uint8_t((_epoch << DIR_BITS) | int(parent));
+  }
+
+  /**
+   * @return the direction from a visited cell back to the cell it was
+   * reached from, or @ref direction::INVALID for the start of the walk
+   * or a cell that has not been visited.
+   **/
+  direction parent(cell_id id) const {
+    if (!visited(id) || id == _root) return direction::INVALID;
+    return direction(mark(id) & ((1 << DIR_BITS) - 1));
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
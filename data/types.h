@@ -0,0 +1,62 @@
+/**
+ * @file types.h defines the basic types used to address the cells of a
+ * maze. It is kept separate from maze.h so that headers which are
+ * included by maze.h can also refer to cells.
+ **/
+#pragma once
+#include <cstdint>
+namespace mazer2018 {
+namespace data {
+/**
+ * a handle to a cell of a maze. How cells are numbered depends on the
+ * maze's layout (see layout.h) - for the default row-major layout the
+ * cell at x, y has the handle y * width + x. Handles are 64 bit so that a
+ * maze may hold billions of cells; coordinates stay as int.
+ **/
+using cell_id = std::int64_t;
+
+/**
+ * enumeration that represents a direction from a cell in terms
+ * of the traditional cardinal directions: north, south, etc.
+ **/
+enum class direction {
+  /**
+   * represents a cell above the current cell
+   **/
+  NORTH,
+  /**
+   * represents a cell below the current cell
+   **/
+  SOUTH,
+  /**
+   * represents a cell to the right of the current cell
+   **/
+  EAST,
+  /**
+   * represents a cell to the left of the current cell
+   **/
+  WEST,
+  /**
+   * represents an invalid direction
+   **/
+  INVALID
+};
+
+/**
+ * the number of valid directions from a cell
+ **/
+const int num_dirs = 4;
+
+/**
+ * the change in x coordinate when moving one cell in each direction,
+ * indexed by direction
+ **/
+const int dir_dx[num_dirs] = {0, 0, 1, -1};
+
+/**
+ * the change in y coordinate when moving one cell in each direction,
+ * indexed by direction
+ **/
+const int dir_dy[num_dirs] = {-1, 1, 0, 0};
+}  // namespace data
+}  // namespace mazer2018
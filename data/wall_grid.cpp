@@ -0,0 +1,129 @@
+#include "wall_grid.h"
+#include <algorithm>
+#include <bitset>
+
+/**
+ * @param cells the number of cells the grid should hold
+ **/
+void mazer2018::data::wall_grid::resize(std::size_t cells) {
+  // a read-only mapping can't be written to so a new grid goes on the heap
+  if (_storage->read_only()) _storage.reset(new heap_storage());
+  _cells = cells;
+  // round up to a whole number of blocks
+  std::size_t blocks = (cells + BLOCK_BITS - 1) >> BLOCK_SHIFT;
+  _num_words = 2 * blocks;
+  _words = _storage->allocate(_num_words);
+  _sparse = _storage->sparse();
+  _tiles = _storage->tiles();
+}
+
+/**
+ * only the words that have a passage in them are written, so copying a
+ * sparse grid costs the number of chunks it holds rather than its size.
+ * @param other the grid to copy, which must be the same size as this one
+ **/
+void mazer2018::data::wall_grid::copy_words(const wall_grid& other) {
+  if (other._sparse) {
+    other._sparse->for_each_chunk(
+        [&](std::size_t key, const std::uint64_t* chunk) {
+          std::size_t first = key * sparse_words::CHUNK;
+          for (std::size_t i = 0; i < sparse_words::CHUNK; ++i) {
+            if (chunk[i]) update(first + i, chunk[i], true);
+          }
+        });
+    return;
+  }
+  if (_words && other._words) {
+    std::copy(other._words, other._words + _num_words, _words);
+    return;
+  }
+  // a procedural grid is read in order so each tile is only worked out
+  // once
+  for (std::size_t i = 0; i < _num_words; ++i) {
+    std::uint64_t word = other.word(i);
+    if (word) update(i, word, true);
+  }
+}
+
+/**
+ * @param storage the storage to hold the grid from now on
+ **/
+void mazer2018::data::wall_grid::storage(
+    std::unique_ptr<grid_storage> storage) {
+  wall_grid old = std::move(*this);
+  _storage = std::move(storage);
+  resize(old._cells);
+  copy_words(old);
+}
+
+/**
+ * @param other the grid to copy
+ **/
+void mazer2018::data::wall_grid::assign(const wall_grid& other) {
+  resize(other._cells);
+  copy_words(other);
+}
+
+/**
+ * @param on whether the grid should be sparse
+ **/
+void mazer2018::data::wall_grid::sparse(bool on) {
+  if (on == sparse()) return;
+  if (on) {
+    storage(std::unique_ptr<grid_storage>(new sparse_storage()));
+  } else {
+    storage(std::unique_ptr<grid_storage>(new heap_storage()));
+  }
+}
+
+/**
+ * @param storage the storage holding the grid
+ * @param cells the number of cells in the grid
+ **/
+bool mazer2018::data::wall_grid::attach(std::unique_ptr<grid_storage> storage,
+                                        std::size_t cells) {
+  std::size_t blocks = (cells + BLOCK_BITS - 1) >> BLOCK_SHIFT;
+  if (storage->size() != 2 * blocks) return false;
+  _storage = std::move(storage);
+  _cells = cells;
+  _num_words = 2 * blocks;
+  _words = _storage->data();
+  _sparse = _storage->sparse();
+  _tiles = _storage->tiles();
+  return true;
+}
+
+void mazer2018::data::wall_grid::clear(void) {
+  if (_sparse) {
+    _sparse->clear();
+    return;
+  }
+  std::fill(_words, _words + _num_words, 0);
+}
+
+/**
+ * bits past the last cell are never set so a plain population count over
+ * every word gives the number of passages.
+ **/
+std::size_t mazer2018::data::wall_grid::count(void) const {
+  std::size_t total = 0;
+  if (_sparse) {
+    _sparse->for_each_chunk([&](std::size_t, const std::uint64_t* chunk) {
+      for (std::size_t i = 0; i < sparse_words::CHUNK; ++i) {
+        total += std::bitset<64>(chunk[i]).count();
+      }
+    });
+    return total;
+  }
+  if (_tiles) {
+    // every tile of a procedural grid has to be worked out to count it
+    for (std::size_t i = 0; i < _num_words; ++i) {
+      total += std::bitset<64>(_tiles->get(i)).count();
+    }
+    return total;
+  }
+  for (std::size_t i = 0; i < _num_words; ++i) {
+    total += std::bitset<64>(_words[i]).count();
+  }
+  return total;
+}
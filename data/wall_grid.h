@@ -0,0 +1,258 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "storage.h"
+#include "types.h"
+
+#pragma once
+/**
+ * @file wall_grid.h defines the bit-packed grid that holds the topology of
+ * a maze.
+ **/
+namespace mazer2018 {
+namespace data {
+/**
+ * bit-packed storage for the passages of a maze. Every cell owns exactly
+ * two bits: whether there is a passage to the cell on its east (x + 1) and
+ * whether there is a passage to the cell on its south (y + 1). A passage
+ * to the west or north is the east or south bit of the neighbouring cell,
+ * so each undirected edge of the maze is stored exactly once.
+ *
+ * The grid is addressed by cell handle. Cells are grouped into blocks of
+ * 64 consecutive handles and each block is stored as a pair of words -
+ * the east bits followed by the south bits - so that the whole grid is a
+ * single contiguous buffer that can be processed a word at a time.
+ *
+ * Where that buffer lives is up to the grid's @ref grid_storage - the
+ * heap by default, or a memory mapped maze file. A sparse grid instead
+ * keeps its words in chunks that are allocated when a passage in them is
+ * first opened; every access then goes through the chunk index. A
+ * procedural grid is never held at all: its words are worked out a tile
+ * at a time as they are read and only the tiles read most recently are
+ * kept - see @ref tile_storage. It can be read but not changed.
+ **/
+class wall_grid {
+  /// the number of cells held in the grid
+  std::size_t _cells;
+  /// where the words of the grid are held
+  std::unique_ptr<grid_storage> _storage;
+  /// the east / south word pairs for every block in the grid, owned by
+  /// the storage, or nullptr for a sparse grid
+  std::uint64_t* _words;
+  /// the chunks holding the words of a sparse grid, owned by the storage,
+  /// or nullptr
+  sparse_words* _sparse;
+  /// the storage that works out the words of a procedural grid, or
+  /// nullptr
+  tile_storage* _tiles;
+  /// the number of words in the grid
+  std::size_t _num_words;
+
+  /**
+   * @return the index of the east word of the block holding a cell. The
+   * south word immediately follows it.
+   **/
+  static std::size_t word_index(cell_id id) {
+    return 2 * (std::size_t(id) >> BLOCK_SHIFT);
+  }
+
+  /**
+   * @return the mask that selects the bit of a cell within its block
+   **/
+  static std::uint64_t bit(cell_id id) {
+    return std::uint64_t(1) << (std::size_t(id) & (BLOCK_BITS - 1));
+  }
+
+  /**
+   * sets or clears the bits of a word selected by a mask. Closing a
+   * passage in a sparse grid never allocates a chunk.
+   **/
+  void update(std::size_t index, std::uint64_t mask, bool open) {
+    if (_words) {
+      std::uint64_t& word = _words[index];
+      word = open ? word | mask : word & ~mask;
+      return;
+    }
+    if (!open && !(_sparse->get(index) & mask)) return;
+    std::uint64_t& word = _sparse->touch(index);
+    word = open ? word | mask : word & ~mask;
+  }
+
+  /**
+   * copies the words of another grid of the same size into this one
+   **/
+  void copy_words(const wall_grid&);
+
+ public:
+  /// the number of cells held in each block
+  static const int BLOCK_BITS = 64;
+  /// log2 of @ref BLOCK_BITS
+  static const int BLOCK_SHIFT = 6;
+
+  /**
+   * default constructor - an empty grid with no cells
+   **/
+  wall_grid(void)
+      : _cells(0),
+        _storage(new heap_storage()),
+        _words(nullptr),
+        _sparse(nullptr),
+        _tiles(nullptr),
+        _num_words(0) {}
+
+  /**
+   * constructs a grid of the specified number of cells with no passages
+   **/
+  explicit wall_grid(std::size_t cells) : wall_grid() { resize(cells); }
+
+  wall_grid(wall_grid&&) = default;
+  wall_grid& operator=(wall_grid&&) = default;
+
+  /**
+   * changes the number of cells in the grid. Any existing passages are
+   * discarded so the grid has no passages afterwards. A grid over
+   * read-only storage moves to the heap.
+   **/
+  void resize(std::size_t cells);
+
+  /**
+   * moves the grid onto different storage, copying its passages across
+   **/
+  void storage(std::unique_ptr<grid_storage>);
+
+  /**
+   * makes this grid a copy of another, keeping this grid's kind of
+   * storage
+   **/
+  void assign(const wall_grid&);
+
+  /**
+   * moves the grid onto sparse storage, or off it onto the heap, keeping
+   * its passages
+   **/
+  void sparse(bool);
+
+  /**
+   * @return whether the grid is held in sparse storage
+   **/
+  bool sparse(void) const { return _sparse != nullptr; }
+
+  /**
+   * @return whether the words of the grid are worked out as they are read
+   **/
+  bool procedural(void) const { return _tiles != nullptr; }
+
+  /**
+   * adopts storage that already holds a grid of the number of cells
+   * specified - for example a mapped maze file - without copying it.
+   * @return false if the storage holds the wrong number of words
+   **/
+  bool attach(std::unique_ptr<grid_storage>, std::size_t cells);
+
+  /**
+   * @return the storage that holds the words of the grid
+   **/
+  grid_storage& storage(void) { return *_storage; }
+
+  /**
+   * @return the storage that holds the words of the grid
+   **/
+  const grid_storage& storage(void) const { return *_storage; }
+
+  /**
+   * removes every passage from the grid
+   **/
+  void clear(void);
+
+  /// @return the number of cells in the grid
+  std::size_t size(void) const { return _cells; }
+
+  /**
+   * @return whether there is a passage from a cell to its east neighbour
+   **/
+  bool east(cell_id id) const {
+    return (word(word_index(id)) & bit(id)) != 0;
+  }
+
+  /**
+   * @return whether there is a passage from a cell to its south neighbour
+   **/
+  bool south(cell_id id) const {
+    return (word(word_index(id) + 1) & bit(id)) != 0;
+  }
+
+  /**
+   * opens or closes the passage from a cell to its east neighbour
+   **/
+  void set_east(cell_id id, bool open) {
+    update(word_index(id), bit(id), open);
+  }
+
+  /**
+   * opens or closes the passage from a cell to its south neighbour
+   **/
+  void set_south(cell_id id, bool open) {
+    update(word_index(id) + 1, bit(id), open);
+  }
+
+  /**
+   * opens the passage from a cell to its east neighbour while other
+   * threads may be opening passages of other cells in the same block. The
+   * grid must not be sparse.
+   **/
+  void open_east_shared(cell_id id) {
+    __atomic_fetch_or(&_words[word_index(id)], bit(id), __ATOMIC_RELAXED);
+  }
+
+  /**
+   * opens the passage from a cell to its south neighbour while other
+   * threads may be opening passages of other cells in the same block. The
+   * grid must not be sparse.
+   **/
+  void open_south_shared(cell_id id) {
+    __atomic_fetch_or(&_words[word_index(id) + 1], bit(id),
+                      __ATOMIC_RELAXED);
+  }
+
+  /**
+   * @return the number of open passages in the grid
+   **/
+  std::size_t count(void) const;
+
+  /**
+   * @return the word at an index - the east word of block i / 2 when i
+   * is even and its south word when i is odd
+   **/
+  std::uint64_t word(std::size_t i) const {
+    if (_words) return _words[i];
+    return _sparse ? _sparse->get(i) : _tiles->get(i);
+  }
+
+  /**
+   * @return the words that hold the grid - an east word then a south word
+   * for each block of 64 cells - or nullptr if the grid is sparse or
+   * procedural
+   **/
+  std::uint64_t* words(void) { return _words; }
+
+  /**
+   * @return the words that hold the grid
+   **/
+  const std::uint64_t* words(void) const { return _words; }
+
+  /**
+   * @return the number of words that hold the grid
+   **/
+  std::size_t num_words(void) const { return _num_words; }
+
+  /**
+   * @return the number of bytes used to hold the grid
+   **/
+  std::size_t bytes(void) const {
+    if (_sparse) return _sparse->bytes();
+    if (_tiles) return _tiles->bytes();
+    return _num_words * sizeof(_words[0]);
+  }
+};
+}  // namespace data
+}  // namespace mazer2018
@@ -0,0 +1,55 @@
+#include "binary_tree_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+mazer2018::generators::binary_tree_generator::binary_tree_generator(
+    int width, int height, int seed)
+    : _width(width),
+      _height(height),
+      _row_words((std::size_t(width) + 63) / 64),
+      _key(data::mix64(std::uint64_t(std::uint32_t(seed)))),
+      _last_word(~std::uint64_t(0) >> ((64 - width % 64) % 64)),
+      _last_column(std::uint64_t(1) << ((width - 1) % 64)),
+      _east(_row_words),
+      _south(_row_words) {}
+
+/**
+ * @param y the row to work out
+ **/
+void mazer2018::generators::binary_tree_generator::next_row(int y) {
+  const std::size_t last = _row_words - 1;
+  if (y == _height - 1) {
+    // the last row is a single corridor
+    std::fill(_east.begin(), _east.end(), ~std::uint64_t(0));
+    std::fill(_south.begin(), _south.end(), 0);
+    _east[last] &= _last_word & ~_last_column;
+    return;
+  }
+  data::split_mix64 rnd(_key);
+  rnd.discard(std::uint64_t(y) * _row_words);
+  for (std::size_t word = 0; word < _row_words; ++word) {
+    const std::uint64_t coins = rnd();
+    _east[word] = coins;
+    _south[word] = ~coins;
+  }
+  // the last column can only go south
+  _east[last] &= _last_word & ~_last_column;
+  _south[last] = (_south[last] | _last_column) & _last_word;
+}
+
+/**
+ * @param sinks where each row goes once it is finished
+ **/
+bool mazer2018::generators::binary_tree_generator::generate(
+    const std::vector<data::row_sink*>& sinks) {
+  auto start_time = std::chrono::system_clock::now();
+  if (!data::stream_rows(_width, _height, sinks, _east.data(), _south.data(),
+                         [this](int y) { next_row(y); })) {
+    return false;
+  }
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+  return true;
+}
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <vector>
+#include "../data/random.h"
+#include "../data/row_sink.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a maze with the binary tree algorithm: every cell but the
+ * bottom right one opens a passage either east or south, chosen at
+ * random, except along the last column, which can only go south, and the
+ * last row, which can only go east. Every cell then has exactly one way
+ * towards the bottom right corner, so the maze is perfect. It has a strong
+ * diagonal grain, with the last row and column as unbroken corridors.
+ *
+ * No cell depends on any other, so a whole word of 64 cells is decided at
+ * once: one random word gives the east passages of 64 cells and its
+ * complement their south passages, and the two edges are patched with
+ * masks. Rows are streamed to @ref data::row_sink objects as they are
+ * made, so a maze of any height costs O(width) memory.
+ *
+ * The random words of each row are a stretch of one counter-based stream
+ * that is jumped to directly, so each row depends only on the seed and
+ * the row.
+ **/
+class binary_tree_generator {
+  /// the size of the maze
+  int _width, _height;
+  /// the number of words in each bit array of a row
+  std::size_t _row_words;
+  /// the key the random words of every row are drawn from
+  std::uint64_t _key;
+  /// the cells of the last word of a row that are in the maze
+  std::uint64_t _last_word;
+  /// the bit of the last column in the last word of a row
+  std::uint64_t _last_column;
+  /// the passages of the current row - see @ref data::row_sink
+  std::vector<std::uint64_t> _east, _south;
+
+  /**
+   * works out the passages of row y into @ref _east and @ref _south
+   **/
+  void next_row(int y);
+
+ public:
+  /**
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the passages opened
+   **/
+  binary_tree_generator(int width, int height, int seed);
+
+  /**
+   * generates the maze into each of the sinks
+   * @return false if any sink failed
+   **/
+  bool generate(const std::vector<data::row_sink*>& sinks);
+};
+}  // namespace generators
+}  // namespace mazer2018
@@ -0,0 +1,100 @@
+#include "eller_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+/**
+ * @return a if c is true and b if not, without a branch. The compiler
+ * turns c ? a : b over values loaded from memory back into a branch.
+ **/
+inline int select(bool c, int a, int b) { return b ^ ((a ^ b) & -int(c)); }
+}  // namespace
+
+mazer2018::generators::eller_generator::eller_generator(int width,
+                                                        int height, int seed)
+    : _width(width),
+      _height(height),
+      _row_words((std::size_t(width) + 63) / 64),
+      _rnd(data::mix64(std::uint64_t(std::uint32_t(seed)))),
+      _right(std::size_t(width)),
+      _left(std::size_t(width)),
+      _down(std::size_t(width), 0),
+      _east(_row_words),
+      _south(_row_words) {
+  // every cell of the first row starts in a set of its own
+  for (int x = 0; x < width; ++x) {
+    _right[x] = _left[x] = x;
+  }
+}
+
+/**
+ * @param y the row to work out
+ **/
+void mazer2018::generators::eller_generator::next_row(int y) {
+  const bool last = y == _height - 1;
+  int* right = _right.data();
+  int* left = _left.data();
+  std::uint8_t* down = _down.data();
+  // join neighbours in different sets at random - all of them on the last
+  // row - by splicing the list of x + 1 in after x
+  for (std::size_t word = 0; word < _row_words; ++word) {
+    const std::uint64_t coins = last ? ~std::uint64_t(0) : _rnd();
+    const int first = int(word * 64),
+              end = std::min(_width - 1, first + 64);
+    std::uint64_t east = 0;
+    for (int x = first; x < end; ++x) {
+      const bool join = (right[x] != x + 1) & bool((coins >> (x & 63)) & 1);
+      const int before = left[x + 1], after = right[x];
+      right[x] = select(join, x + 1, after);
+      left[x + 1] = select(join, x, before);
+      right[before] = select(join, after, right[before]);
+      left[after] = select(join, before, left[after]);
+      east |= std::uint64_t(join) << (x & 63);
+    }
+    _east[word] = east;
+  }
+  if (last) {
+    std::fill(_south.begin(), _south.end(), 0);
+    return;
+  }
+  // open passages south at random, but always at least one per set: the
+  // last cell of a set without one opens one. Whether an earlier cell has
+  // opened one is passed along the set in down. A cell without a passage
+  // south leaves its set, so the cell below it starts a new one.
+  for (std::size_t word = 0; word < _row_words; ++word) {
+    const std::uint64_t coins = _rnd();
+    const int first = int(word * 64), end = std::min(_width, first + 64);
+    std::uint64_t south = 0;
+    for (int x = first; x < end; ++x) {
+      const int next = right[x], prev = left[x];
+      const bool opened = (prev < x) & (down[x] != 0);
+      const bool open = ((next <= x) & !opened) |
+                        bool((coins >> (x & 63)) & 1);
+      // written for the first cell of a set too, which is never read
+      down[next] = opened | open;
+      left[next] = select(open, left[next], prev);
+      right[prev] = select(open, right[prev], next);
+      left[x] = select(open, left[x], x);
+      right[x] = select(open, right[x], x);
+      south |= std::uint64_t(open) << (x & 63);
+    }
+    _south[word] = south;
+  }
+}
+
+/**
+ * @param sinks where each row goes once it is finished
+ **/
+bool mazer2018::generators::eller_generator::generate(
+    const std::vector<data::row_sink*>& sinks) {
+  auto start_time = std::chrono::system_clock::now();
+  if (!data::stream_rows(_width, _height, sinks, _east.data(), _south.data(),
+                         [this](int y) { next_row(y); })) {
+    return false;
+  }
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+  return true;
+}
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <vector>
+#include "../data/random.h"
+#include "../data/row_sink.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a maze with Eller's algorithm, one row at a time, keeping only
+ * the current row in memory. Every cell of a row belongs to a set of cells
+ * that are already joined. Neighbouring cells in different sets are joined
+ * at random, then each set opens at least one passage south, and the
+ * cells below those passages carry their sets into the next row. The last
+ * row joins every set that is left, which makes the maze perfect.
+ *
+ * Finished rows are passed straight to @ref data::row_sink objects, so a
+ * maze of any height costs O(width) memory and is written as fast as the
+ * sinks can take it.
+ *
+ * The paths that join the cells of a set run through the rows above it, so
+ * two sets never cross - if cells a < c < b < d had a and b in one set and
+ * c and d in another the paths would have to meet. Each set is therefore
+ * held as a circular list of its cells in column order, which makes every
+ * step O(1): x and x + 1 are in the same set exactly when x + 1 follows x,
+ * and two sets are joined by splicing their lists together at x.
+ *
+ * Each row takes one random word per 64 cells for the passages east and
+ * one for the passages south. Whether a passage is opened is random, so
+ * rather than branch on it the lists are rewritten either way, with the
+ * values they already hold when nothing changes.
+ **/
+class eller_generator {
+  /// the size of the maze
+  int _width, _height;
+  /// the number of words in each bit array of a row
+  std::size_t _row_words;
+  /// decides which passages are opened
+  data::split_mix64 _rnd;
+  /// the next cell in the set of each cell of the current row, wrapping
+  /// around from the last cell of the set to the first
+  std::vector<int> _right;
+  /// the previous cell in the set of each cell, wrapping around from the
+  /// first to the last
+  std::vector<int> _left;
+  /// whether a cell of the set before this cell has opened a passage
+  /// south, passed along the set as the row is scanned
+  std::vector<std::uint8_t> _down;
+  /// the passages of the current row - see @ref data::row_sink
+  std::vector<std::uint64_t> _east, _south;
+
+  /**
+   * works out the passages of row y into @ref _east and @ref _south
+   **/
+  void next_row(int y);
+
+ public:
+  /**
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the passages opened
+   **/
+  eller_generator(int width, int height, int seed);
+
+  /**
+   * generates the maze into each of the sinks
+   * @return false if any sink failed
+   **/
+  bool generate(const std::vector<data::row_sink*>& sinks);
+};
+}  // namespace generators
+}  // namespace mazer2018
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "../data/frontier.h"
+#include "../data/random.h"
+#include "../data/types.h"
+
+namespace mazer2018 {
+	namespace generators {
+		/*
+		 * the selection policies of the growing tree generator. Each decides
+		 * which cell of the frontier the maze grows from next and how a cell
+		 * with no unvisited neighbours leaves the frontier:
+		 *
+		 *   std::size_t pick(std::size_t size, data::split_mix64&)
+		 *       the position of the next cell in a frontier of size cells
+		 *   void remove(data::frontier<data::cell_id>&, std::size_t pos)
+		 *       removes the cell at pos from the frontier
+		 *
+		 * The policy is a template parameter of grow_tree_generator so both
+		 * calls are inlined into the generator's loop.
+		 */
+
+		// always the newest cell - a recursive backtracker, which gives long
+		// winding corridors
+		struct newest_policy
+		{
+			std::size_t pick(std::size_t size, data::split_mix64&) const {
+				return size - 1;
+			}
+			void remove(data::frontier<data::cell_id>& cells, std::size_t pos) const {
+				cells.remove(pos);
+			}
+		};
+
+		// any cell, chosen uniformly - Prim's algorithm, which gives many
+		// short dead ends
+		struct random_policy
+		{
+			std::size_t pick(std::size_t size, data::split_mix64& rnd) const {
+				return std::size_t(rnd.below(size));
+			}
+			void remove(data::frontier<data::cell_id>& cells, std::size_t pos) const {
+				cells.remove(pos);
+			}
+		};
+
+		// always the oldest cell - the maze grows outwards from the start in
+		// long straight corridors
+		struct oldest_policy
+		{
+			std::size_t pick(std::size_t, data::split_mix64&) const {
+				return 0;
+			}
+			void remove(data::frontier<data::cell_id>& cells, std::size_t) const {
+				cells.pop_front();
+			}
+		};
+
+		// the newest cell for a percentage of picks and a random cell for the
+		// rest, blending the textures of the two
+		struct mixed_policy
+		{
+			// the percentage of picks that take the newest cell, 0 to 100
+			unsigned newest_percent;
+
+			explicit mixed_policy(unsigned percent = 50) : newest_percent(percent) {}
+
+			std::size_t pick(std::size_t size, data::split_mix64& rnd) const {
+				if (rnd.below(100) < newest_percent) {
+					return size - 1;
+				}
+				return std::size_t(rnd.below(size));
+			}
+			// the oldest cell fills the hole so the newest cells keep their
+			// order for later newest picks, and a newest cell that is removed
+			// is popped so the next newest pick backtracks as newest does
+			void remove(data::frontier<data::cell_id>& cells, std::size_t pos) const {
+				cells.remove_front_fill(pos);
+			}
+		};
+
+		// a random cell among the newest few - a backtracker that branches
+		// more as the window widens
+		struct window_policy
+		{
+			// the number of newest cells to choose from
+			std::size_t window;
+
+			explicit window_policy(std::size_t size = 8) : window(std::max<std::size_t>(size, 1)) {}
+
+			std::size_t pick(std::size_t size, data::split_mix64& rnd) const {
+				return size - 1 - std::size_t(rnd.below(std::min(window, size)));
+			}
+			// the last cell is in the window too, so moving it into the hole
+			// leaves the window holding the same cells
+			void remove(data::frontier<data::cell_id>& cells, std::size_t pos) const {
+				cells.remove(pos);
+			}
+		};
+	}
+
+}
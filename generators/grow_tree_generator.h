@@ -2,31 +2,109 @@
 
 #include <chrono>
 #include <functional>
-#include <random>
 #include <ctime>
 #include <vector>
 #include <algorithm>
 
+#include "../data/arena.h"
+#include "../data/frontier.h"
 #include "../data/maze.h"
+#include "../data/random.h"
+#include "../data/traversal.h"
+#include "grow_policies.h"
 
 namespace mazer2018 {
 	namespace generators {
-		class grow_tree_generator
+		// the state shared by every growing tree generator, whatever its
+		// selection policy
+		class grow_tree_base
 		{
 		public:
-			grow_tree_generator(data::maze& m, int width, int height, int seed);
+			grow_tree_base(data::maze& m, int seed, int width, int height);
 
-			virtual mazer2018::data::cell *get_next_cell() = 0;
-			void generate();
+			// prints the time taken by a run and the scratch memory it used
+			void report(std::chrono::system_clock::time_point start_time);
 
 			data::maze& mymaze;
 			int seed, width, height;
-			std::mt19937 rndgen;
-			data::set<data::cell> maze_set;
+			data::split_mix64 rndgen;
+			// scratch memory for a single generation, freed along with the
+			// generator. Declared before the containers that draw from it.
+			data::arena scratch;
+			data::frontier<data::cell_id> cells;
+			data::traversal_context context;
+		};
+
+		// the growing tree algorithm: grow the maze from a frontier of cells,
+		// taking the cell the Policy picks (see grow_policies.h) and carving
+		// to a random unvisited neighbour of it
+		template <class Policy>
+		class grow_tree_generator : public grow_tree_base
+		{
+		public:
+			grow_tree_generator(data::maze& m, int seed, int width, int height, Policy policy = Policy())
+				: grow_tree_base(m, seed, width, height), select(policy) {}
+
+			// grows the maze and reports how long it took
+			void generate();
+
+			// grows the maze without reporting anything, for callers that
+			// run many generators
+			void grow();
 
+			Policy select;
 		};
+
+		template <class Policy>
+		void grow_tree_generator<Policy>::generate() {
+			auto start_time = std::chrono::system_clock::now();
+			grow();
+			report(start_time);
+		}
+
+		template <class Policy>
+		void grow_tree_generator<Policy>::grow() {
+			cells.clear();
+			context.reset(mymaze);
+			// start in the top left corner, or the first cell of a masked maze
+			data::cell_id start = mymaze.first_cell();
+			cells.push(start);
+			context.visit(start);
+			// the order neighbours are considered in - it decides which cell
+			// each random number picks
+			static const data::direction order[data::num_dirs] = {
+				data::direction::NORTH, data::direction::SOUTH,
+				data::direction::WEST, data::direction::EAST};
+			// the unvisited neighbours of the current cell and the direction
+			// of each, kept on the stack so the loop never allocates
+			data::cell_id adj_cells[data::num_dirs];
+			data::direction adj_dirs[data::num_dirs];
+			while (!cells.empty()) {
+				std::size_t pos = select.pick(cells.size(), rndgen);
+				data::cell_id cell = cells[pos];
+				int num_adj = 0;
+				for (data::direction dir : order) {
+					if (!mymaze.has_neighbour(cell, dir)) {
+						continue;
+					}
+					data::cell_id tmp_cell = mymaze.neighbour(cell, dir);
+					if (!context.visited(tmp_cell)) {
+						adj_cells[num_adj] = tmp_cell;
+						adj_dirs[num_adj++] = dir;
+					}
+				}
+				if (num_adj == 0) {
+					select.remove(cells, pos);
+					continue;
+				}
+				int pick = int(rndgen.below(unsigned(num_adj)));
+				data::cell_id new_cell = adj_cells[pick];
+				cells.push(new_cell);
+				context.visit(new_cell, !adj_dirs[pick]);
+				mymaze.set_passage(cell, adj_dirs[pick], true);
+			}
+		}
 	}
-	
-}
 
+}
 
@@ -0,0 +1,203 @@
+#include "kruskal_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "../data/disjoint_set.h"
+#include "../data/parallel.h"
+#include "../data/random.h"
+
+mazer2018::generators::kruskal_generator::kruskal_generator(
+    data::maze& m, int width, int height, int seed, unsigned threads)
+    : _maze(m),
+      _key(data::mix64(std::uint64_t(std::uint32_t(seed)))),
+      _threads(data::thread_count(threads)) {
+  m.height(height);
+  m.width(width);
+  m.init();
+  // looking cells up in a mask is not safe from several threads at once
+  if (m.masked()) _threads = 1;
+}
+
+std::uint64_t mazer2018::generators::kruskal_generator::num_walls(
+    void) const {
+  std::uint64_t width = std::uint64_t(_maze.width()),
+                height = std::uint64_t(_maze.height());
+  return (width - 1) * height + width * (height - 1);
+}
+
+/**
+ * @param first the number of the first wall
+ * @param last one past the number of the last wall
+ * @param f called with the number of each wall and the wall itself
+ **/
+template <class F>
+void mazer2018::generators::kruskal_generator::for_each_wall(
+    std::uint64_t first, std::uint64_t last, F f) const {
+  const int width = _maze.width();
+  const std::uint64_t east_walls = std::uint64_t(width - 1) * _maze.height();
+  // one wall to the east or south of a cell, if it is between cells in use
+  auto visit = [&](std::uint64_t number, int x, int y, data::direction dir) {
+    data::cell_id id = _maze.index(x, y);
+    if (_maze.masked() &&
+        (!_maze.active(id) || !_maze.has_neighbour(id, dir))) {
+      return;
+    }
+    f(number, 2 * id + (dir == data::direction::SOUTH));
+  };
+  std::uint64_t number = first;
+  if (number < east_walls) {
+    int x = int(number % std::uint64_t(width - 1)),
+        y = int(number / std::uint64_t(width - 1));
+    for (; number < std::min(last, east_walls); ++number) {
+      visit(number, x, y, data::direction::EAST);
+      if (++x == width - 1) {
+        x = 0;
+        ++y;
+      }
+    }
+  }
+  if (number < last) {
+    int x = int((number - east_walls) % std::uint64_t(width)),
+        y = int((number - east_walls) / std::uint64_t(width));
+    for (; number < last; ++number) {
+      visit(number, x, y, data::direction::SOUTH);
+      if (++x == width) {
+        x = 0;
+        ++y;
+      }
+    }
+  }
+}
+
+/**
+ * @param number the number of the wall
+ **/
+std::size_t mazer2018::generators::kruskal_generator::bucket(
+    std::uint64_t number) const {
+  return std::size_t((data::mix64(_key + number) >> 32) * BUCKETS >> 32);
+}
+
+/**
+ * the walls are counted into their buckets a chunk at a time, the counts
+ * give every chunk its place in every bucket, and the walls are then
+ * written to those places and each bucket shuffled. Every step is split
+ * into the same tasks whatever the number of threads.
+ **/
+void mazer2018::generators::kruskal_generator::shuffle_walls(void) {
+  const std::uint64_t total = num_walls();
+  const std::size_t chunks = std::size_t((total + CHUNK - 1) / CHUNK);
+  // the number of walls each chunk sends to each bucket, which then
+  // becomes the position the chunk writes its next wall to in each bucket
+  std::vector<std::uint64_t> places(chunks * BUCKETS, 0);
+  data::parallel_for(_threads, chunks, [&](std::size_t chunk, unsigned) {
+    std::uint64_t* count = &places[chunk * BUCKETS];
+    for_each_wall(chunk * CHUNK, std::min(total, (chunk + 1) * CHUNK),
+                  [&](std::uint64_t number, data::cell_id) {
+                    ++count[bucket(number)];
+                  });
+  });
+  std::vector<std::uint64_t> starts(BUCKETS + 1);
+  std::uint64_t next = 0;
+  for (std::size_t b = 0; b < BUCKETS; ++b) {
+    starts[b] = next;
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+      std::uint64_t count = places[chunk * BUCKETS + b];
+      places[chunk * BUCKETS + b] = next;
+      next += count;
+    }
+  }
+  starts[BUCKETS] = next;
+  _walls.resize(std::size_t(next));
+  data::parallel_for(_threads, chunks, [&](std::size_t chunk, unsigned) {
+    std::uint64_t* place = &places[chunk * BUCKETS];
+    for_each_wall(chunk * CHUNK, std::min(total, (chunk + 1) * CHUNK),
+                  [&](std::uint64_t number, data::cell_id wall) {
+                    _walls[place[bucket(number)]++] = wall;
+                  });
+  });
+  // each bucket shuffles with its own stretch of one stream, jumped to
+  // directly. No bucket comes near 2^40 walls, so the stretches never
+  // overlap.
+  const std::uint64_t shuffle_key = data::mix64(~_key);
+  data::parallel_for(_threads, BUCKETS, [&](std::size_t b, unsigned) {
+    data::split_mix64 rnd(shuffle_key);
+    rnd.discard(std::uint64_t(b) << 40);
+    data::shuffle(_walls.begin() + starts[b], _walls.begin() + starts[b + 1],
+                  rnd);
+  });
+}
+
+void mazer2018::generators::kruskal_generator::generate(void) {
+  auto start_time = std::chrono::system_clock::now();
+  shuffle_walls();
+  if (_threads == 1) {
+    merge();
+  } else {
+    merge_parallel();
+  }
+  // the walls take twice as much memory as the rest of the run so give
+  // them back straight away
+  std::vector<data::cell_id>().swap(_walls);
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+}
+
+/**
+ * a spanning tree of n cells has n - 1 passages, so the merge stops as
+ * soon as that many walls have gone rather than checking the rest.
+ **/
+void mazer2018::generators::kruskal_generator::merge(void) {
+  data::disjoint_set sets(std::size_t(_maze.capacity()));
+  data::cell_id remaining =
+      (_maze.masked() ? _maze.mask()->count() : _maze.size()) - 1;
+  for (data::cell_id wall : _walls) {
+    if (remaining == 0) break;
+    data::cell_id id = wall >> 1;
+    data::direction dir =
+        (wall & 1) ? data::direction::SOUTH : data::direction::EAST;
+    if (sets.unite(id, _maze.neighbour(id, dir))) {
+      _maze.set_passage(id, dir, true);
+      --remaining;
+    }
+  }
+}
+
+/**
+ * no sets are joined while a batch is being struck out, so each answer is
+ * exact, and a wall whose cells were joined before its batch would have
+ * been kept by @ref merge too.
+ **/
+void mazer2018::generators::kruskal_generator::merge_parallel(void) {
+  // the number of walls each task strikes out
+  const std::size_t PER_TASK = 4096;
+  data::concurrent_disjoint_set sets(std::size_t(_maze.capacity()));
+  data::cell_id remaining = _maze.size() - 1;
+  std::vector<std::uint8_t> joined(BATCH);
+  for (std::size_t first = 0; first < _walls.size() && remaining > 0;
+       first += BATCH) {
+    const std::size_t count =
+        std::min(std::size_t(BATCH), _walls.size() - first);
+    data::parallel_for(
+        _threads, (count + PER_TASK - 1) / PER_TASK,
+        [&](std::size_t task, unsigned) {
+          std::size_t end = std::min(count, (task + 1) * PER_TASK);
+          for (std::size_t i = task * PER_TASK; i < end; ++i) {
+            data::cell_id wall = _walls[first + i], id = wall >> 1;
+            data::direction dir =
+                (wall & 1) ? data::direction::SOUTH : data::direction::EAST;
+            joined[i] = sets.same(id, _maze.neighbour(id, dir));
+          }
+        });
+    for (std::size_t i = 0; i < count && remaining > 0; ++i) {
+      if (joined[i]) continue;
+      data::cell_id wall = _walls[first + i], id = wall >> 1;
+      data::direction dir =
+          (wall & 1) ? data::direction::SOUTH : data::direction::EAST;
+      if (sets.unite(id, _maze.neighbour(id, dir))) {
+        _maze.set_passage(id, dir, true);
+        --remaining;
+      }
+    }
+  }
+}
@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <vector>
+#include "../data/maze.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a maze with Kruskal's algorithm: every wall between two cells
+ * is considered once in a random order and is knocked down if the cells
+ * on either side of it are not yet joined. A disjoint set over the cells
+ * tracks which cells are joined.
+ *
+ * The walls are shuffled on several threads. Each wall is sent to one of
+ * @ref BUCKETS buckets by a hash of the seed and the wall's position and
+ * each bucket is then shuffled on its own, which gives a uniformly random
+ * order that depends only on the seed.
+ *
+ * With one thread the walls are then merged in order with a
+ * @ref data::disjoint_set. With more they are merged a batch at a time:
+ * the threads first strike out, in parallel, every wall of the batch whose
+ * cells were already joined before the batch, using a
+ * @ref data::concurrent_disjoint_set, and the walls that are left are
+ * merged in order. Striking out a wall never changes the result so the
+ * maze is the same whatever the number of threads.
+ **/
+class kruskal_generator {
+ public:
+  /// the number of buckets the walls are shuffled through
+  static const std::size_t BUCKETS = 1024;
+  /// the number of walls handled by each task while shuffling
+  static const std::uint64_t CHUNK = std::uint64_t(1) << 20;
+  /// the number of walls in each batch of a parallel merge
+  static const std::size_t BATCH = std::size_t(1) << 18;
+
+ private:
+  /// the maze to generate into
+  data::maze& _maze;
+  /// the key the random order of the walls is derived from
+  std::uint64_t _key;
+  /// the number of threads to use
+  unsigned _threads;
+  /// every wall between two cells in use, in random order. A wall is the
+  /// handle of the cell on its west or north side times 2, plus 1 for a
+  /// wall to the south.
+  std::vector<data::cell_id> _walls;
+
+  /**
+   * @return the number of walls, in use or not, in a maze of this size
+   **/
+  std::uint64_t num_walls(void) const;
+
+  /**
+   * calls f(wall) for each wall between two cells in use from the wall
+   * numbered first up to but not including last. Walls are numbered
+   * row by row, all of the walls to the east and then all of the walls to
+   * the south, so the numbering does not depend on the layout.
+   **/
+  template <class F>
+  void for_each_wall(std::uint64_t first, std::uint64_t last, F f) const;
+
+  /**
+   * @return the bucket a numbered wall is shuffled through
+   **/
+  std::size_t bucket(std::uint64_t number) const;
+
+  /**
+   * fills @ref _walls with every wall in random order
+   **/
+  void shuffle_walls(void);
+
+  /**
+   * knocks down walls in order with a single thread
+   **/
+  void merge(void);
+
+  /**
+   * knocks down walls in order with several threads
+   **/
+  void merge_parallel(void);
+
+ public:
+  /**
+   * @param m the maze to generate into
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the random order of the walls
+   * @param threads the number of threads to use, or 0 for one per core
+   **/
+  kruskal_generator(data::maze& m, int width, int height, int seed,
+                    unsigned threads);
+
+  /**
+   * generates the maze
+   **/
+  void generate(void);
+};
+}  // namespace generators
+}  // namespace mazer2018
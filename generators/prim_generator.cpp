@@ -1 +0,0 @@
-#include "prim_generator.h"
\ No newline at end of file
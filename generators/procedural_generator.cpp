@@ -0,0 +1,103 @@
+#include "procedural_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "recursivegen.h"
+
+namespace {
+using mazer2018::generators::recursivegen;
+
+/**
+ * works out the tiles of a maze divided by @ref recursivegen
+ **/
+class division_tiles : public mazer2018::data::tile_source {
+  /// the size of a tile in each direction
+  static const int TILE = 64;
+  /// the whole maze
+  recursivegen::region _whole;
+  /// the key of the maze
+  std::uint64_t _key;
+  /// the number of tiles in each row of tiles
+  std::uint64_t _tiles_x;
+
+ public:
+  division_tiles(int width, int height, std::uint64_t key)
+      : _whole{0, 0, width, height},
+        _key(key),
+        _tiles_x(std::uint64_t(width + TILE - 1) / TILE) {}
+
+  /**
+   * each row of a tile is one block of the tiled64 layout, so row y of
+   * the tile is words 2y (east) and 2y + 1 (south) with a bit per column
+   * @param tile the number of the tile - tiles are numbered row by row
+   * @param words where the words of the tile go
+   **/
+  virtual void fill(std::uint64_t tile, std::uint64_t* words) const {
+    using mazer2018::data::direction;
+    using mazer2018::data::tile_storage;
+    std::fill(words, words + tile_storage::TILE_WORDS, 0);
+    // the cells of the tile that are in the maze
+    const int left = int(tile % _tiles_x) * TILE;
+    const int top = int(tile / _tiles_x) * TILE;
+    const int right = std::min(left + TILE, _whole.width);
+    const int bottom = std::min(top + TILE, _whole.height);
+    auto overlaps = [&](const recursivegen::region& r) {
+      return r.x < right && r.x + r.width > left && r.y < bottom &&
+             r.y + r.height > top;
+    };
+    auto open = [&](int x, int y, direction dir) {
+      const int word = 2 * (y - top) + (dir == direction::SOUTH ? 1 : 0);
+      words[word] |= std::uint64_t(1) << (x - left);
+    };
+    // only the regions that overlap the tile are followed - the passages
+    // of any other region are owned by cells outside it
+    std::vector<recursivegen::region> stack{_whole};
+    while (!stack.empty()) {
+      const recursivegen::region r = stack.back();
+      stack.pop_back();
+      // a single row or column is a corridor, of which only the part in
+      // the tile is wanted
+      if (r.height == 1) {
+        for (int x = std::max(r.x, left);
+             x < std::min(r.x + r.width - 1, right); ++x) {
+          open(x, r.y, direction::EAST);
+        }
+        continue;
+      }
+      if (r.width == 1) {
+        for (int y = std::max(r.y, top);
+             y < std::min(r.y + r.height - 1, bottom); ++y) {
+          open(r.x, y, direction::SOUTH);
+        }
+        continue;
+      }
+      const recursivegen::division d = recursivegen::cut(_key, r);
+      if (d.x >= left && d.x < right && d.y >= top && d.y < bottom) {
+        open(d.x, d.y, d.dir);
+      }
+      if (overlaps(d.first)) stack.push_back(d.first);
+      if (overlaps(d.second)) stack.push_back(d.second);
+    }
+  }
+};
+}  // namespace
+
+mazer2018::generators::procedural_generator::procedural_generator(
+    data::maze& m, int width, int height, int seed, std::size_t tiles)
+    : _maze(m),
+      _width(width),
+      _height(height),
+      _key(recursivegen::key(seed)),
+      _tiles(tiles) {}
+
+void mazer2018::generators::procedural_generator::generate(void) {
+  auto start_time = std::chrono::system_clock::now();
+  _maze.procedural(_width, _height,
+                   std::unique_ptr<data::tile_source>(
+                       new division_tiles(_width, _height, _key)),
+                   _tiles);
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+}
@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <cstdint>
+#include "../data/maze.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * makes a procedural maze - one that is never generated in full. It is
+ * the maze @ref recursivegen divides from the same seed, but a 64x64 tile
+ * of it is only worked out when something reads it, and only the tiles
+ * read most recently are kept - see @ref data::maze::procedural. The
+ * maze is ready as soon as it is asked for and holds a bounded amount of
+ * memory however big it is, while every query through the maze answers
+ * as if the whole maze were there.
+ *
+ * Where recursive division cuts a region depends on nothing but the seed
+ * and the region, so a tile is worked out by following the division down
+ * from the whole maze into just the regions that overlap the tile, and
+ * keeping the passages owned by its cells. Those are exactly the passages
+ * of the tile in the full maze, so tiles always join up across their
+ * borders and the maze is perfect.
+ **/
+class procedural_generator {
+  /// the maze to make procedural
+  data::maze& _maze;
+  /// the size of the maze
+  int _width, _height;
+  /// the key the random numbers of each region are derived from
+  std::uint64_t _key;
+  /// the most tiles the maze holds at once
+  std::size_t _tiles;
+
+ public:
+  /// the most tiles a procedural maze holds at once unless another number
+  /// is given - 4MiB of passages
+  static const std::size_t DEFAULT_TILES = 4096;
+
+  /**
+   * @param m the maze to make procedural
+   * @param width the width of the maze
+   * @param height the height of the maze
+   * @param seed the seed the maze is divided from
+   * @param tiles the most tiles the maze holds at once
+   **/
+  procedural_generator(data::maze& m, int width, int height, int seed,
+                       std::size_t tiles = DEFAULT_TILES);
+
+  /**
+   * makes the maze procedural. No passages are worked out until they are
+   * read.
+   **/
+  void generate(void);
+};
+}  // namespace generators
+}  // namespace mazer2018
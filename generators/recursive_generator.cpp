@@ -1 +0,0 @@
-#include "recursive_generator.h"
\ No newline at end of file
@@ -5,19 +5,8 @@
 
 namespace mazer2018 {
 	namespace generators {
-		class recursive_generator : public grow_tree_generator
-		{
-		public:
-			recursive_generator(data::maze& m, int seed, int width, int height) : grow_tree_generator(m, seed, width, height) {};
-
-			mazer2018::data::cell *get_next_cell();
-		};
-
-		mazer2018::data::cell *recursive_generator::get_next_cell() {
-			return maze_set.get_end();
-		}
-
+		// the recursive backtracker - a growing tree that picks the newest cell
+		using recursive_generator = grow_tree_generator<newest_policy>;
 	}
 
 }
-
@@ -1,83 +1,161 @@
 #include "recursivegen.h"
+#include <chrono>
+#include <iostream>
+#include "../data/parallel.h"
+#include "../data/random.h"
+
+namespace {
+using mazer2018::generators::recursivegen;
 
 /**
- * fills the maze to be fully connected then decide on a random orientation
- * to start the maze. we then call splitter which does the actual work
+ * @return the seed of the random numbers for a region, which depends only
+ * on the key of the maze and the position and size of the region. No two
+ * regions of one maze are the same, as each is strictly inside the region
+ * it was cut from.
  **/
-void mazer2018::generators::recursivegen::generate() {
-  // make the maze a fully connected maze
-  // mymaze.fill();
-  mymaze.init();
-  // set the width and height of the maze
-  int width = mymaze.width();
-  int height = mymaze.height();
-  // set the orientation for the start of the maze
-  std::uniform_int_distribution<int> dir_dist(0, 1);
-  int start_dir = dir_dist(rndgen);
-  // set the recursive function going that does the work
-  splitter(0, width - 1, 0, height - 1, data::orientation(start_dir));
+inline std::uint64_t region_seed(std::uint64_t key,
+                                 const recursivegen::region& r) {
+  using mazer2018::data::mix64;
+  return key ^
+         mix64(std::uint64_t(std::uint32_t(r.x)) << 32 |
+               std::uint32_t(r.y)) ^
+         mix64(~(std::uint64_t(std::uint32_t(r.width)) << 32 |
+                 std::uint32_t(r.height)));
+}
+}  // namespace
+
+mazer2018::generators::recursivegen::recursivegen(data::maze& m, int width,
+                                                  int height, int seed,
+                                                  unsigned threads,
+                                                  std::size_t cutoff)
+    : mymaze(m),
+      _key(key(seed)),
+      _threads(data::thread_count(threads)),
+      _cutoff(cutoff) {
+  // resize the maze to width and height specified
+  m.height(height);
+  m.width(width);
 }
 
 /**
- * @param low_x the low end of this submaze's x coordinates
- * @param high_x the high end of this submaze's x coordinates
- * @param low_y the low end of this submaze's y coordinates
- * @param high_y the high end of this submaze's y coordinates
+ * @param seed the seed of the maze
  **/
-void mazer2018::generators::recursivegen::splitter(int low_x, int high_x,
-                                                   int low_y, int high_y,
-                                                   data::orientation orient) {
-  // import the data namespace to shortcut the length of some of the code
-  using namespace data;
+std::uint64_t mazer2018::generators::recursivegen::key(int seed) {
+  return data::mix64(std::uint64_t(std::uint32_t(seed)));
+}
 
-  // check the distance between high and low coordinates and return when
-  // this is equal to one
-  int xdiff = high_x - low_x;
-  int ydiff = high_y - low_y;
-  if (xdiff <= GRANULARITY || ydiff <= GRANULARITY) return;
-  int wall_x = low_x + rndgen() % xdiff;
-  int wall_y = low_y + rndgen() % ydiff;
+/**
+ * @param key the key of the maze
+ * @param r the region to cut
+ **/
+mazer2018::generators::recursivegen::division
+mazer2018::generators::recursivegen::cut(std::uint64_t key, const region& r) {
+  data::split_mix64 rnd(region_seed(key, r));
+  data::orientation orient =
+      r.width > r.height
+          ? data::VERTICAL
+          : r.height > r.width ? data::HORIZONTAL
+                               : data::orientation(rnd() & 1);
+  if (orient == data::HORIZONTAL) {
+    // cut between rows at - 1 and at, with the gap in column gap
+    int at = r.y + 1 + int(rnd.below(unsigned(r.height - 1)));
+    int gap = r.x + int(rnd.below(unsigned(r.width)));
+    return division{region{r.x, r.y, r.width, at - r.y},
+                    region{r.x, at, r.width, r.y + r.height - at}, gap, at - 1,
+                    data::direction::SOUTH};
+  }
+  // cut between columns at - 1 and at, with the gap in row gap
+  int at = r.x + 1 + int(rnd.below(unsigned(r.width - 1)));
+  int gap = r.y + int(rnd.below(unsigned(r.height)));
+  return division{region{r.x, r.y, at - r.x, r.height},
+                  region{at, r.y, r.x + r.width - at, r.height}, at - 1, gap,
+                  data::direction::EAST};
+}
 
-  // check the orientation - the orientation dictates whether we are
-  // processing the maze vertically or horizontally on this iteration
-  if (orient == data::orientation::VERTICAL) {
-    // decide at which point to insert a hole
-    int reinsert = rndgen() % (ydiff + low_y);
-    // insert the wall at each point other than where we will insert a
-    // hole
-    for (int x_count = low_x; x_count < high_x; ++x_count) {
-      // if this is where we will insert a hole, do it and then start
-      // the next iteration of this loop
-      if (x_count == reinsert) {
-        mymaze.delete_wall(x_count, wall_y, orientation::VERTICAL);
-        continue;
-      }
-      mymaze.insert_wall(x_count, wall_y, orient);
+/**
+ * @param r the region to divide
+ * @param shared whether other threads are opening passages at the same time
+ * @param push called with each half of the region if it is cut
+ **/
+template <class F>
+void mazer2018::generators::recursivegen::divide(const region& r,
+                                                 bool shared, F push) {
+  using data::direction;
+  auto open = [&](int x, int y, direction dir) {
+    data::cell_id id = mymaze.index(x, y);
+    if (shared) {
+      mymaze.open_passage_shared(id, dir);
+    } else {
+      mymaze.set_passage(id, dir, true);
     }
-  } else {
-    // orientation is horizontal
-
-    // decide at which point to insert a hole
-    int reinsert = rndgen() % (xdiff + low_x);
-    // insert a wall at each point other than where we insert the hole
-    for (int y_count = low_y; y_count <= high_y; ++y_count) {
-      // insert the hole
-      if (y_count == reinsert) {
-        mymaze.delete_wall(wall_x, y_count, data::orientation::HORIZONTAL);
-        continue;
-      }
-      // remove connections from this cell to its neighbours in a
-      // horizontal direction
-      mymaze.insert_wall(wall_x, y_count, orient);
+  };
+  // a single row or column can only be a corridor
+  if (r.height == 1) {
+    for (int x = r.x; x < r.x + r.width - 1; ++x) {
+      open(x, r.y, direction::EAST);
+    }
+    return;
+  }
+  if (r.width == 1) {
+    for (int y = r.y; y < r.y + r.height - 1; ++y) {
+      open(r.x, y, direction::SOUTH);
     }
+    return;
   }
-  // change the orientation
-  orient = !orient;
+  division d = cut(_key, r);
+  open(d.x, d.y, d.dir);
+  push(d.first);
+  push(d.second);
+}
+
+/**
+ * @param r the region to divide
+ * @param shared whether other threads are opening passages at the same time
+ * @param stack scratch space for the regions still to be divided, which is
+ * left empty
+ **/
+void mazer2018::generators::recursivegen::divide_all(
+    const region& r, bool shared, std::vector<region>& stack) {
+  stack.push_back(r);
+  while (!stack.empty()) {
+    region next = stack.back();
+    stack.pop_back();
+    divide(next, shared, [&](const region& half) { stack.push_back(half); });
+  }
+}
+
+/**
+ * regions of at least @ref _cutoff cells are cut once per task and their
+ * halves spawned as new tasks. Smaller ones are finished off within the
+ * task that reached them.
+ **/
+void mazer2018::generators::recursivegen::splitter(const region& whole) {
+  // cells in neighbouring regions share the words of the passage grid,
+  // which a masked maze keeps sparse
+  const unsigned threads = mymaze.sparse() ? 1 : _threads;
+  const bool shared = threads > 1;
+  std::vector<std::vector<region>> stacks(threads);
+  data::parallel_tasks(
+      threads, whole,
+      [&](const region& r, unsigned worker, data::task_queues<region>& queue) {
+        if (std::size_t(r.width) * std::size_t(r.height) < _cutoff) {
+          divide_all(r, shared, stacks[worker]);
+          return;
+        }
+        divide(r, shared,
+               [&](const region& half) { queue.push(worker, half); });
+      });
+}
 
-  // divide the rest of the maze into four from this point and process
-  // the submazes
-  splitter(low_x, wall_x, wall_y, high_y, orient);
-  splitter(wall_x, high_x, wall_y, high_y, orient);
-  splitter(low_x, wall_x, low_y, wall_y, orient);
-  splitter(wall_x, high_x, low_y, wall_y, orient);
+/**
+ * starts the maze without any passages and divides it from the whole maze
+ * down
+ **/
+void mazer2018::generators::recursivegen::generate() {
+  auto start_time = std::chrono::system_clock::now();
+  mymaze.init();
+  splitter(region{0, 0, mymaze.width(), mymaze.height()});
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
 }
@@ -1,7 +1,6 @@
-#include <chrono>
-#include <functional>
-#include <random>
-#include <ctime>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 #include "../constants/constants.h"
 #include "../data/maze.h"
 
@@ -12,9 +11,66 @@ namespace mazer2018 {
  **/
 namespace generators {
 /**
- * class that implements a recursive ...
+ * generates a maze by recursive division. A region of the maze is cut in
+ * two by a wall across its shorter side - either way for a square region -
+ * with a single gap in it, and each half is divided in the same way until
+ * it is a single row or column, which is left as one corridor. Each half
+ * is a perfect maze of its own and the gap is the only way between them,
+ * so the whole maze is perfect.
+ *
+ * The two halves of a region never share a cell, so once a region is cut
+ * its halves are divided as independent tasks on a pool of threads that
+ * steal work from each other - see @ref data::parallel_tasks. Regions of
+ * fewer cells than the cutoff aren't worth a task and are divided on the
+ * thread that reached them instead.
+ *
+ * Where a region is cut and where its gap goes come from a random number
+ * generator seeded from the seed of the maze and the position and size of
+ * the region alone, so the maze is the same whatever the number of
+ * threads or the cutoff, and whichever order the regions are divided in.
  **/
 class recursivegen {
+ public:
+  /**
+   * a part of the maze still to be divided
+   **/
+  struct region {
+    /// the top left cell of the region
+    int x, y;
+    /// the size of the region
+    int width, height;
+  };
+
+  /**
+   * how a region is cut in two
+   **/
+  struct division {
+    /// the two halves of the region
+    region first, second;
+    /// the cell that owns the passage through the wall between the halves
+    int x, y;
+    /// the direction of that passage from the cell - east or south
+    data::direction dir;
+  };
+
+  /// the number of cells below which a region is divided on the thread
+  /// that reached it rather than as a task, unless another is given
+  static const std::size_t DEFAULT_CUTOFF = std::size_t(1) << 14;
+
+  /**
+   * @return the key the random numbers of the regions of a maze are
+   * derived from
+   **/
+  static std::uint64_t key(int seed);
+
+  /**
+   * @return how a region of a maze with the key given is cut. The region
+   * must be at least two cells wide and two high. It depends on nothing
+   * but the key and the region, so any part of a maze can be worked out
+   * without dividing the rest of it.
+   **/
+  static division cut(std::uint64_t key, const region&);
+
  protected:
   /**
    * a reference to the maze we will manipulate. We use a
@@ -23,32 +79,40 @@ class recursivegen {
    **/
   data::maze& mymaze;
 
-  /**
-   * the random number generator.
-   **/
-  std::mt19937 rndgen;
+  /// the key the random numbers of each region are derived from
+  std::uint64_t _key;
+
+  /// the number of threads to use
+  unsigned _threads;
+
+  /// regions of fewer cells than this are not divided as tasks
+  std::size_t _cutoff;
 
   /**
-   * the range of numbers over which we will generate random
-   * numbers.
+   * divides a region once: a single row or column is opened as a corridor
+   * and anything bigger is cut in two, with its halves passed to push
+   * @param shared whether other threads are opening passages at the same
+   * time
    **/
-  std::uniform_int_distribution<int> dist;
+  template <class F>
+  void divide(const region&, bool shared, F push);
 
   /**
-   * the smallest distance between cells that we will allow for
-   * recursion.
+   * divides a region and every region it is cut into on the calling
+   * thread, using a stack rather than recursion as a maze can be cut many
+   * thousands of times over
    **/
-  const int GRANULARITY = 1;
+  void divide_all(const region&, bool shared, std::vector<region>& stack);
 
   /**
-   *  recursive function which involves splitting the maze
+   * divides the whole maze
    **/
-  virtual void splitter(int, int, int, int, data::orientation);
+  virtual void splitter(const region&);
 
  public:
   /**
-   * function simply sets the parameters to start maze generation
-   * then calls the recursive function that does the work.
+   * sets the maze up at the size asked for and then calls splitter which
+   * does the work
    **/
   void generate(void);
 
@@ -58,29 +122,15 @@ class recursivegen {
    * @param width the width of the maze to generate
    * @param height the height of the maze to generate
    * @param seed the seed for the random number generator
+   * @param threads the number of threads to use, or 0 for one per core
+   * @param cutoff the number of cells below which a region is not divided
+   * as a task of its own
    **/
   recursivegen(data::maze& m, int width, int height,
-               int seed = constants::ERROR)
-      : mymaze(m), dist(0, std::max(width, height)) {
-    // resize the maze to width and height specified
-    m.height(height);
-    m.width(width);
-    /*
-     * tests if the seed has been passed in. If it has
-     * not, we use the current time in milliseconds
-     */
-    if (seed == constants::ERROR) {
-      auto time = std::chrono::system_clock::now();
-      std::time_t now = std::chrono::system_clock::to_time_t(time);
-      seed = now;
-      // print out the seed we are going to use
-      std::cout << "The seed we are using is: " << seed << std::endl;
-    }
-    /* initialize the random number generator with the
-     * seed specified
-     */
-    rndgen = std::mt19937(seed);
-  }
+               int seed = constants::ERROR, unsigned threads = 1,
+               std::size_t cutoff = DEFAULT_CUTOFF);
+
+  virtual ~recursivegen(void) {}
 };
 }  // namespace generators
 }  // namespace mazer2018
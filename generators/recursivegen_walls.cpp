@@ -0,0 +1,110 @@
+#include "recursivegen_walls.h"
+#include <algorithm>
+
+namespace {
+/**
+ * opens the first bits of each of a number of lines of a bitmap
+ * @param words the bitmap, each line of which is line_words words
+ * @param lines the number of lines to open
+ * @param bits the number of bits of each line to open
+ **/
+void open_lines(std::vector<std::uint64_t>& words, std::size_t line_words,
+                std::size_t lines, std::size_t bits) {
+  const std::uint64_t last = ~std::uint64_t(0) >> ((64 - bits % 64) % 64);
+  for (std::size_t line = 0; line < lines; ++line) {
+    std::uint64_t* first = &words[line * line_words];
+    std::fill(first, first + line_words, ~std::uint64_t(0));
+    first[line_words - 1] = last;
+  }
+}
+
+/**
+ * builds a wall along a line of a bitmap: bits first to last - 1 are
+ * cleared except for the gap
+ **/
+void build_wall(std::uint64_t* line, std::size_t first, std::size_t last,
+                std::size_t gap) {
+  std::size_t word = first >> 6;
+  const std::size_t end = last >> 6;
+  const std::uint64_t head = ~std::uint64_t(0) << (first & 63);
+  const std::uint64_t tail = (std::uint64_t(1) << (last & 63)) - 1;
+  if (word == end) {
+    line[word] &= ~(head & tail);
+  } else {
+    line[word] &= ~head;
+    while (++word < end) line[word] = 0;
+    if (tail) line[end] &= ~tail;
+  }
+  line[gap >> 6] |= std::uint64_t(1) << (gap & 63);
+}
+
+/**
+ * transposes a 64x64 bit matrix in place so that bit j of word i becomes
+ * bit i of word j, by swapping ever smaller blocks across the diagonal
+ **/
+void transpose(std::uint64_t* block) {
+  std::uint64_t mask = 0x00000000FFFFFFFFull;
+  for (int size = 32; size; size >>= 1, mask ^= mask << size) {
+    for (int k = 0; k < 64; k = (k + size + 1) & ~size) {
+      const std::uint64_t swap = ((block[k] >> size) ^ block[k + size]) & mask;
+      block[k] ^= swap << size;
+      block[k + size] ^= swap;
+    }
+  }
+}
+}  // namespace
+
+/**
+ * @param whole the region covering the whole maze
+ **/
+void mazer2018::generators::recursivegen_walls::splitter(const region& whole) {
+  const std::size_t width = std::size_t(whole.width),
+                    height = std::size_t(whole.height);
+  const std::size_t row_words = (width + 63) / 64,
+                    column_words = (height + 63) / 64;
+  // south passages row by row and east passages column by column, open
+  // everywhere but through the outside of the maze
+  std::vector<std::uint64_t> south(row_words * height),
+      east(column_words * width);
+  open_lines(south, row_words, height - 1, width);
+  open_lines(east, column_words, width - 1, height);
+  // a maze a single row or column wide is a corridor with nothing to cut
+  std::vector<region> regions;
+  if (whole.width > 1 && whole.height > 1) regions.push_back(whole);
+  while (!regions.empty()) {
+    const region r = regions.back();
+    regions.pop_back();
+    const division d = cut(_key, r);
+    if (d.dir == data::direction::SOUTH) {
+      build_wall(&south[std::size_t(d.y) * row_words], std::size_t(r.x),
+                 std::size_t(r.x + r.width), std::size_t(d.x));
+    } else {
+      build_wall(&east[std::size_t(d.x) * column_words], std::size_t(r.y),
+                 std::size_t(r.y + r.height), std::size_t(d.y));
+    }
+    // a single row or column is left as the corridor it already is
+    if (d.first.width > 1 && d.first.height > 1) regions.push_back(d.first);
+    if (d.second.width > 1 && d.second.height > 1) {
+      regions.push_back(d.second);
+    }
+  }
+  // turn each band of 64 rows of east passages back into rows
+  std::vector<std::uint64_t> rows(64 * row_words);
+  std::uint64_t block[64];
+  for (std::size_t band = 0; band < column_words; ++band) {
+    for (std::size_t word = 0; word < row_words; ++word) {
+      for (std::size_t i = 0; i < 64; ++i) {
+        const std::size_t x = word * 64 + i;
+        block[i] = x < width ? east[x * column_words + band] : 0;
+      }
+      transpose(block);
+      for (std::size_t j = 0; j < 64; ++j) {
+        rows[j * row_words + word] = block[j];
+      }
+    }
+    for (std::size_t j = 0; j < 64 && band * 64 + j < height; ++j) {
+      const std::size_t y = band * 64 + j;
+      mymaze.open_row(int(y), &rows[j * row_words], &south[y * row_words]);
+    }
+  }
+}
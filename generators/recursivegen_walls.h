@@ -0,0 +1,35 @@
+#include "recursivegen.h"
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * implements the recursive division method the way it is usually
+ * described: the maze starts fully open and each cut builds a wall
+ * across its region with one gap left in it. It generates the same maze
+ * as @ref recursivegen does from the same seed.
+ *
+ * The walls are built in a pair of bitmaps rather than in the maze. The
+ * south passages are held row by row and the east passages column by
+ * column, so every wall - whichever way it runs - is a run of bits in
+ * consecutive words and is built with a masked operation on each word it
+ * covers rather than a step for each cell. A region one cell wide or high
+ * needs no work at all, as it is already a corridor. The bitmaps are then
+ * written into the maze a row at a time, the east passages turned back
+ * into rows 64x64 bits at a time.
+ **/
+class recursivegen_walls : public recursivegen {
+ public:
+  /**
+   * inherit the constructor from the parent
+   **/
+  using recursivegen::recursivegen;
+
+ protected:
+  /**
+   * divides every region on one stack on the calling thread, building
+   * walls in the bitmaps, and then writes the bitmaps into the maze
+   **/
+  virtual void splitter(const region&) override;
+};
+}  // namespace generators
+}  // namespace mazer2018
@@ -0,0 +1,62 @@
+#include <cstdint>
+#include <vector>
+#include "../data/random.h"
+#include "../data/row_sink.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a maze with the sidewinder algorithm. The last row is a single
+ * corridor. Every other row is cut into runs of cells joined east to
+ * west, a run carrying on east from each cell at random, and each run
+ * opens one passage south from a cell chosen at random along it. Each run
+ * is then joined to the rows below it by exactly one passage, so the maze
+ * is perfect. Unlike a binary tree maze it has no diagonal grain, only a
+ * vertical one.
+ *
+ * A row depends on nothing but its own random numbers. Whether each cell
+ * carries its run on east is decided a word of 64 cells at a time from one
+ * random word, and the runs are then walked from end to end with a bit
+ * scan of that word rather than a cell at a time. Rows are streamed to
+ * @ref data::row_sink objects as they are made, so a maze of any height
+ * costs O(width) memory.
+ *
+ * The random numbers of each row come from its own counter-based stream,
+ * so each row depends only on the seed and the row.
+ **/
+class sidewinder_generator {
+  /// the size of the maze
+  int _width, _height;
+  /// the number of words in each bit array of a row
+  std::size_t _row_words;
+  /// the key the random numbers of every row are drawn from
+  std::uint64_t _key;
+  /// the cells of the last word of a row that are in the maze
+  std::uint64_t _last_word;
+  /// the bit of the last column in the last word of a row
+  std::uint64_t _last_column;
+  /// the passages of the current row - see @ref data::row_sink
+  std::vector<std::uint64_t> _east, _south;
+
+  /**
+   * works out the passages of row y into @ref _east and @ref _south
+   **/
+  void next_row(int y);
+
+ public:
+  /**
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the passages opened
+   **/
+  sidewinder_generator(int width, int height, int seed);
+
+  /**
+   * generates the maze into each of the sinks
+   * @return false if any sink failed
+   **/
+  bool generate(const std::vector<data::row_sink*>& sinks);
+};
+}  // namespace generators
+}  // namespace mazer2018
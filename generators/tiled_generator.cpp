@@ -0,0 +1,145 @@
+#include "tiled_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include "../data/disjoint_set.h"
+#include "../data/parallel.h"
+#include "../data/random.h"
+
+mazer2018::generators::tiled_generator::tiled_generator(
+    data::maze& m, int width, int height, int seed, unsigned threads,
+    tile_function generate_tile)
+    : _maze(m),
+      _seed(seed),
+      _threads(data::thread_count(threads)),
+      _generate_tile(std::move(generate_tile)) {
+  m.height(height);
+  m.width(width);
+  m.init();
+  // spread the remainder over every tile rather than leaving a sliver at
+  // the edge
+  int tiles_x = std::max(1, (width + TILE / 2) / TILE),
+      tiles_y = std::max(1, (height + TILE / 2) / TILE);
+  for (int i = 0; i <= tiles_x; ++i) {
+    _tile_x.push_back(int(std::int64_t(width) * i / tiles_x));
+  }
+  for (int i = 0; i <= tiles_y; ++i) {
+    _tile_y.push_back(int(std::int64_t(height) * i / tiles_y));
+  }
+}
+
+/**
+ * @param tile the index of the tile, row by row
+ **/
+int mazer2018::generators::tiled_generator::tile_seed(std::size_t tile) const {
+  // neighbouring tiles get unrelated seeds
+  std::uint64_t z =
+      data::mix64((std::uint64_t(std::uint32_t(_seed)) << 32) + tile);
+  return int(z & 0x7fffffff);
+}
+
+void mazer2018::generators::tiled_generator::generate(void) {
+  auto start_time = std::chrono::system_clock::now();
+  const std::size_t tiles_x = _tile_x.size() - 1,
+                    num_tiles = tiles_x * (_tile_y.size() - 1);
+  // each tile is a maze of its own until it is copied in
+  std::vector<std::unique_ptr<data::maze>> tiles(num_tiles);
+  data::parallel_for(_threads, num_tiles, [&](std::size_t t, unsigned) {
+    std::size_t tx = t % tiles_x, ty = t / tiles_x;
+    tiles[t].reset(new data::maze(_tile_x[tx + 1] - _tile_x[tx],
+                                  _tile_y[ty + 1] - _tile_y[ty]));
+    _generate_tile(*tiles[t], tile_seed(t));
+  });
+  copy_tiles(tiles);
+  tiles.clear();
+  join_tiles();
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+  std::cout << "generated " << num_tiles << " tiles on " << _threads
+            << " threads" << std::endl;
+}
+
+/**
+ * the work is split by cell handle rather than by tile. Every task covers
+ * whole blocks of the passage grid, so no two threads ever write to the
+ * same word whatever the layout of the maze.
+ * @param tiles the generated tiles, row by row
+ **/
+void mazer2018::generators::tiled_generator::copy_tiles(
+    const std::vector<std::unique_ptr<data::maze>>& tiles) {
+  const std::size_t tiles_x = _tile_x.size() - 1;
+  // the column of tiles each column of the maze is in, and the row of
+  // tiles each row is in
+  std::vector<int> column_tile(_maze.width()), row_tile(_maze.height());
+  for (std::size_t i = 0; i < tiles_x; ++i) {
+    std::fill(column_tile.begin() + _tile_x[i],
+              column_tile.begin() + _tile_x[i + 1], int(i));
+  }
+  for (std::size_t i = 0; i + 1 < _tile_y.size(); ++i) {
+    std::fill(row_tile.begin() + _tile_y[i], row_tile.begin() + _tile_y[i + 1],
+              int(i));
+  }
+  const data::cell_id capacity = _maze.capacity(),
+                      chunk = data::cell_id(data::wall_grid::BLOCK_BITS) * 1024;
+  std::size_t tasks = std::size_t((capacity + chunk - 1) / chunk);
+  data::parallel_for(_threads, tasks, [&](std::size_t task, unsigned) {
+    data::cell_id first = data::cell_id(task) * chunk,
+                  last = std::min(capacity, first + chunk);
+    for (data::cell_id id = first; id < last; ++id) {
+      int x = _maze.x_of(id), y = _maze.y_of(id);
+      // skip the padding of a tiled layout
+      if (!_maze.valid_cell(x, y)) continue;
+      int tx = column_tile[x], ty = row_tile[y];
+      const data::maze& tile = *tiles[ty * tiles_x + tx];
+      data::cell_id local = tile.index(x - _tile_x[tx], y - _tile_y[ty]);
+      if (tile.grid().east(local)) {
+        _maze.set_passage(id, data::direction::EAST, true);
+      }
+      if (tile.grid().south(local)) {
+        _maze.set_passage(id, data::direction::SOUTH, true);
+      }
+    }
+  });
+}
+
+/**
+ * each tile is a spanning tree of its own cells, so joining the tiles
+ * along a spanning tree of the tiles leaves a spanning tree of the maze.
+ **/
+void mazer2018::generators::tiled_generator::join_tiles(void) {
+  const std::size_t tiles_x = _tile_x.size() - 1,
+                    tiles_y = _tile_y.size() - 1;
+  // every border between neighbouring tiles, as the tile on its north or
+  // west side and the direction across it
+  std::vector<std::pair<std::size_t, data::direction>> borders;
+  for (std::size_t ty = 0; ty < tiles_y; ++ty) {
+    for (std::size_t tx = 0; tx < tiles_x; ++tx) {
+      std::size_t t = ty * tiles_x + tx;
+      if (tx + 1 < tiles_x) borders.emplace_back(t, data::direction::EAST);
+      if (ty + 1 < tiles_y) borders.emplace_back(t, data::direction::SOUTH);
+    }
+  }
+  data::split_mix64 rnd(data::mix64(~std::uint64_t(std::uint32_t(_seed))));
+  data::shuffle(borders.begin(), borders.end(), rnd);
+  data::disjoint_set joined(tiles_x * tiles_y);
+  for (const auto& border : borders) {
+    std::size_t t = border.first, tx = t % tiles_x, ty = t / tiles_x;
+    bool east = border.second == data::direction::EAST;
+    if (!joined.unite(data::cell_id(t),
+                      data::cell_id(east ? t + 1 : t + tiles_x))) {
+      continue;
+    }
+    // open the border at a random cell along it
+    int x, y;
+    if (east) {
+      x = _tile_x[tx + 1] - 1;
+      y = _tile_y[ty] + int(rnd.below(unsigned(_tile_y[ty + 1] - _tile_y[ty])));
+    } else {
+      y = _tile_y[ty + 1] - 1;
+      x = _tile_x[tx] + int(rnd.below(unsigned(_tile_x[tx + 1] - _tile_x[tx])));
+    }
+    _maze.set_passage(x, y, border.second, true);
+  }
+}
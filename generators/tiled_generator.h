@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "../data/maze.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a maze on several threads. The maze is cut into tiles of about
+ * @ref TILE x @ref TILE cells and each tile is generated on a pool of
+ * worker threads as a maze of its own, by whichever generator the caller
+ * provides. The tiles are then copied into the maze and joined into a
+ * single perfect maze by opening one passage across the border of each
+ * pair of neighbouring tiles in a random spanning tree of the tiles,
+ * which is found with a union-find over the tiles.
+ *
+ * The seed of each tile depends only on the seed of the maze and the
+ * position of the tile, so the maze generated is the same whatever the
+ * number of threads.
+ **/
+class tiled_generator {
+ public:
+  /**
+   * generates a single tile. The maze passed in is the size of the tile
+   * and the int is the seed to generate it from.
+   **/
+  using tile_function = std::function<void(data::maze&, int)>;
+
+  /// the size that tiles are cut to, give or take the remainder when the
+  /// maze doesn't divide evenly
+  static const int TILE = 256;
+
+ private:
+  /// the maze to generate into
+  data::maze& _maze;
+  /// the seed for the maze
+  int _seed;
+  /// the number of threads to use
+  unsigned _threads;
+  /// generates each tile
+  tile_function _generate_tile;
+  /// the first column of each column of tiles, followed by the width of
+  /// the maze
+  std::vector<int> _tile_x;
+  /// the first row of each row of tiles, followed by the height of the
+  /// maze
+  std::vector<int> _tile_y;
+
+  /**
+   * @return the seed for a tile, mixed from the seed of the maze and the
+   * tile's index
+   **/
+  int tile_seed(std::size_t tile) const;
+
+  /**
+   * copies the passages of the tiles into the maze, on several threads
+   **/
+  void copy_tiles(const std::vector<std::unique_ptr<data::maze>>& tiles);
+
+  /**
+   * opens the passages between tiles that join them into one maze
+   **/
+  void join_tiles(void);
+
+ public:
+  /**
+   * @param m the maze to generate into
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the random number generators
+   * @param threads the number of threads to use
+   * @param generate_tile generates a single tile
+   **/
+  tiled_generator(data::maze& m, int width, int height, int seed,
+                  unsigned threads, tile_function generate_tile);
+
+  /**
+   * generates the maze
+   **/
+  void generate(void);
+
+  /**
+   * @return whether a maze of the size specified is cut into a single
+   * tile, in which case it may as well be generated directly
+   **/
+  static bool single_tile(int width, int height) {
+    return width < TILE + TILE / 2 && height < TILE + TILE / 2;
+  }
+};
+}  // namespace generators
+}  // namespace mazer2018
@@ -0,0 +1,223 @@
+#include "wilson_generator.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+using mazer2018::data::cell_id;
+
+/**
+ * @return whether x, y is inside a maze of the size specified. Negative
+ * coordinates wrap around to huge unsigned ones so one comparison per
+ * axis is enough.
+ **/
+inline bool inside(int x, int y, int width, int height) {
+  return unsigned(x) < unsigned(width) && unsigned(y) < unsigned(height);
+}
+
+/**
+ * steps between the cells of a maze without a mask in the row-major
+ * layout, where the neighbour in each direction is a fixed distance away
+ **/
+class row_major_step {
+  /// the size of the maze
+  int _width, _height;
+  /// the distance to the neighbour in each direction, indexed by direction
+  cell_id _delta[mazer2018::data::num_dirs];
+
+ public:
+  explicit row_major_step(const mazer2018::data::maze& m)
+      : _width(m.width()),
+        _height(m.height()),
+        _delta{-cell_id(m.width()), cell_id(m.width()), 1, -1} {}
+
+  /**
+   * moves id and x, y to the neighbour in direction dir
+   * @return false, leaving them alone, if there is no such neighbour
+   **/
+  bool move(cell_id& id, int& x, int& y, int dir) const {
+    int next_x = x + mazer2018::data::dir_dx[dir],
+        next_y = y + mazer2018::data::dir_dy[dir];
+    if (!inside(next_x, next_y, _width, _height)) return false;
+    x = next_x;
+    y = next_y;
+    id += _delta[dir];
+    return true;
+  }
+
+  /**
+   * @return the neighbour of a cell in direction dir, which must exist
+   **/
+  cell_id next(cell_id id, int dir) const { return id + _delta[dir]; }
+};
+
+/**
+ * steps between the cells of any maze through its layout, keeping to the
+ * mask if it has one
+ **/
+class layout_step {
+  /// the maze being stepped over
+  const mazer2018::data::maze& _maze;
+  /// the mask of the maze or nullptr
+  const mazer2018::data::cell_mask* _mask;
+
+ public:
+  explicit layout_step(const mazer2018::data::maze& m)
+      : _maze(m), _mask(m.mask()) {}
+
+  /**
+   * moves id and x, y to the neighbour in direction dir
+   * @return false, leaving them alone, if there is no such neighbour
+   **/
+  bool move(cell_id& id, int& x, int& y, int dir) const {
+    int next_x = x + mazer2018::data::dir_dx[dir],
+        next_y = y + mazer2018::data::dir_dy[dir];
+    if (!inside(next_x, next_y, _maze.width(), _maze.height())) return false;
+    // the switch on direction in data::maze::neighbour mispredicts on
+    // nearly every step of a random walk, where index only branches on
+    // the layout
+    cell_id next_id = _maze.index(next_x, next_y);
+    if (_mask && !_mask->test(next_id)) return false;
+    x = next_x;
+    y = next_y;
+    id = next_id;
+    return true;
+  }
+
+  /**
+   * @return the neighbour of a cell in direction dir, which must exist
+   **/
+  cell_id next(cell_id id, int dir) const {
+    return _maze.neighbour(id, mazer2018::data::direction(dir));
+  }
+};
+}  // namespace
+
+mazer2018::generators::wilson_generator::wilson_generator(data::maze& m,
+                                                          int width,
+                                                          int height, int seed)
+    : _maze(m),
+      _rnd(data::mix64(std::uint64_t(std::uint32_t(seed)))),
+      _pool(0),
+      _pool_left(0),
+      _cells(_scratch),
+      _sparse(false),
+      _reachable(_scratch),
+      _cell_count(0) {
+  m.height(height);
+  m.width(width);
+  m.init();
+}
+
+void mazer2018::generators::wilson_generator::prepare(void) {
+  _sparse = _maze.sparse();
+  if (!_sparse) {
+    _cells.assign(std::size_t(_maze.capacity()), 0);
+  }
+  if (!_maze.masked()) {
+    _cell_count = _maze.size();
+    return;
+  }
+  // a mask may be in several pieces and the maze only fills the piece
+  // its first cell is in
+  _cell_count = 0;
+  data::cell_id first = _maze.first_cell();
+  if (first == constants::ERROR) return;
+  data::arena_vector<data::cell_id> pending(_scratch);
+  _reachable.reset(_maze);
+  _reachable.visit(first);
+  pending.push_back(first);
+  while (!pending.empty()) {
+    data::cell_id id = pending.back();
+    pending.pop_back();
+    ++_cell_count;
+    for (int d = 0; d < data::num_dirs; ++d) {
+      data::direction dir = data::direction(d);
+      if (!_maze.has_neighbour(id, dir)) continue;
+      data::cell_id next = _maze.neighbour(id, dir);
+      if (!_reachable.visited(next)) {
+        _reachable.visit(next, !dir);
+        pending.push_back(next);
+      }
+    }
+  }
+}
+
+/**
+ * @param step moves between neighbouring cells - see row_major_step
+ **/
+template <class Step>
+void mazer2018::generators::wilson_generator::wilson(const Step& step) {
+  const bool masked = _maze.masked();
+  state(_maze.first_cell()) = IN_TREE;
+  data::cell_id added = 1;
+  for (int y = 0; y < _maze.height() && added < _cell_count; ++y) {
+    for (int x = 0; x < _maze.width(); ++x) {
+      data::cell_id start = _maze.index(x, y);
+      if (masked && !_reachable.visited(start)) continue;
+      if (state(start) & IN_TREE) continue;
+      // walk until the tree is hit. Going back over a cell overwrites the
+      // direction it was left by, which erases the loop just closed.
+      data::cell_id id = start;
+      int walk_x = x, walk_y = y;
+      do {
+        data::cell_id from = id;
+        int dir = random_dir();
+        if (step.move(id, walk_x, walk_y, dir)) {
+          state(from) = std::uint8_t(dir);
+        }
+      } while (!(state(id) & IN_TREE));
+      // then follow the directions from the start to add the path that is
+      // left to the tree
+      for (id = start; !(state(id) & IN_TREE); ++added) {
+        int dir = state(id) & 3;
+        state(id) = IN_TREE;
+        _maze.set_passage(id, data::direction(dir), true);
+        id = step.next(id, dir);
+      }
+    }
+  }
+}
+
+/**
+ * @param step moves between neighbouring cells - see row_major_step
+ **/
+template <class Step>
+void mazer2018::generators::wilson_generator::aldous_broder(
+    const Step& step) {
+  data::cell_id id = _maze.first_cell();
+  int x = _maze.x_of(id), y = _maze.y_of(id);
+  state(id) = IN_TREE;
+  for (data::cell_id remaining = _cell_count - 1; remaining > 0;) {
+    data::cell_id from = id;
+    int dir = random_dir();
+    if (!step.move(id, x, y, dir)) continue;
+    if (!(state(id) & IN_TREE)) {
+      state(id) = IN_TREE;
+      _maze.set_passage(from, data::direction(dir), true);
+      --remaining;
+    }
+  }
+}
+
+void mazer2018::generators::wilson_generator::generate(void) {
+  auto start_time = std::chrono::system_clock::now();
+  prepare();
+  auto grow = [this](const auto& step) {
+    if (_cell_count <= ALDOUS_BRODER_CELLS) {
+      aldous_broder(step);
+    } else {
+      wilson(step);
+    }
+  };
+  if (_cell_count > 0) {
+    if (!_maze.masked() && _maze.layout() == data::layout_type::ROW_MAJOR) {
+      grow(row_major_step(_maze));
+    } else {
+      grow(layout_step(_maze));
+    }
+  }
+  auto finish_time = std::chrono::system_clock::now();
+  std::chrono::duration<double> total_time = finish_time - start_time;
+  std::cout << "generate cost time:" << total_time.count() << std::endl;
+  _scratch.report(std::cout, "generate");
+}
@@ -0,0 +1,131 @@
+#include <cstdint>
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/random.h"
+#include "../data/sparse_array.h"
+#include "../data/traversal.h"
+
+#pragma once
+namespace mazer2018 {
+namespace generators {
+/**
+ * generates a uniform spanning tree maze - every perfect maze of the size
+ * is equally likely - with Wilson's algorithm. The tree starts as a single
+ * cell and each cell not yet in it starts a random walk that runs until it
+ * hits the tree. The walk with its loops erased is then added to the tree.
+ *
+ * The walk keeps no list of the cells on it. Each cell just remembers the
+ * direction the walk last left it by, which erases a loop as soon as the
+ * walk closes it, and the path is retraced along those directions once
+ * the walk hits the tree. That direction and whether the cell is in the
+ * tree share one byte per cell.
+ *
+ * Mazes of up to @ref ALDOUS_BRODER_CELLS cells are generated with the
+ * Aldous-Broder algorithm instead: a single random walk that opens a
+ * passage into every cell it enters for the first time. It is also
+ * uniform, and for a small maze it finishes before Wilson's algorithm has
+ * paid for its bookkeeping.
+ *
+ * Walks pick a direction from 2 bits of a @ref data::split_mix64 and try
+ * again when the direction leads out of the maze, which keeps each step
+ * to a few instructions. Cells are started from in row order and a walk
+ * only depends on the directions it draws, so a maze without a mask does
+ * not depend on the layout. (A masked maze starts from the first handle
+ * in the mask, which does.)
+ **/
+class wilson_generator {
+ public:
+  /// the largest maze generated with the Aldous-Broder algorithm
+  static const std::int64_t ALDOUS_BRODER_CELLS = 64 * 64;
+
+ private:
+  /// the bit of a cell's state set once the cell is in the tree. The
+  /// bottom 2 bits are the direction a walk last left it by.
+  static const std::uint8_t IN_TREE = 4;
+
+  /// the maze to generate into
+  data::maze& _maze;
+  /// draws the directions of the walks
+  data::split_mix64 _rnd;
+  /// random bits not yet used for a direction
+  std::uint64_t _pool;
+  /// the number of directions left in @ref _pool
+  int _pool_left;
+  /// scratch memory for a single generation
+  data::arena _scratch;
+  /// the state of each cell, indexed by handle
+  data::arena_vector<std::uint8_t> _cells;
+  /// the state of each cell of a sparse maze
+  data::sparse_array<std::uint8_t, 12> _sparse_cells;
+  /// whether the state is held in @ref _sparse_cells
+  bool _sparse;
+  /// the cells of a masked maze that can be reached from its first cell.
+  /// A walk from any other cell would never find the tree.
+  data::traversal_context _reachable;
+  /// the number of cells the tree must grow to
+  data::cell_id _cell_count;
+
+  /**
+   * @return the state of a cell
+   **/
+  std::uint8_t state(data::cell_id id) const {
+    return _sparse ? _sparse_cells.get(std::size_t(id)) : _cells[id];
+  }
+
+  /**
+   * @return a reference to the state of a cell
+   **/
+  std::uint8_t& state(data::cell_id id) {
+    return _sparse ? _sparse_cells.touch(std::size_t(id)) : _cells[id];
+  }
+
+  /**
+   * @return a random direction, as an int
+   **/
+  int random_dir(void) {
+    if (_pool_left == 0) {
+      _pool = _rnd();
+      _pool_left = 64 / 2;
+    }
+    int dir = int(_pool & 3);
+    _pool >>= 2;
+    --_pool_left;
+    return dir;
+  }
+
+  /**
+   * allocates the state of the cells and, for a masked maze, finds the
+   * cells the tree can reach
+   **/
+  void prepare(void);
+
+  /**
+   * grows the tree with Wilson's algorithm, stepping between cells with
+   * step
+   **/
+  template <class Step>
+  void wilson(const Step& step);
+
+  /**
+   * grows the tree with the Aldous-Broder algorithm, stepping between
+   * cells with step
+   **/
+  template <class Step>
+  void aldous_broder(const Step& step);
+
+ public:
+  /**
+   * @param m the maze to generate into
+   * @param width the width of the maze to generate
+   * @param height the height of the maze to generate
+   * @param seed the seed for the walks
+   **/
+  wilson_generator(data::maze& m, int width, int height, int seed);
+
+  /**
+   * generates the maze
+   **/
+  void generate(void);
+};
+}  // namespace generators
+}  // namespace mazer2018
@@ -3,6 +3,7 @@
 #include "args/action.h"
 #include "args/arg_processor.h"
 #include "data/maze.h"
+#include "generators/procedural_generator.h"
 #include "generators/recursivegen.h"
 
 /**
@@ -47,7 +48,7 @@ int main(int argc, char** argv) {
     mazer2018::data::maze m;
     // perform all actions requested by the command line arguments
     for (auto& action : actions) {
-      m = action->do_action(m);
+      action->do_action(m);
     }
 
   } catch (mazer2018::args::action_failed& af) {
@@ -84,11 +85,143 @@ void display_usage(void) {
             << "must specify height." << std::endl
             << std::endl
             << std::endl;
-  std::cout << "We have also provided an iterative solution where you "
-            << "may specify this with the " << std::endl;
-  std::cout << "flag --gs. This flag behaves the "
-            << "same as --g except that it runs the iterative" << std::endl;
-  std::cout << "implementation." << std::endl << std::endl;
+  std::cout << "--g generates the maze by recursive division, spreading "
+            << "the regions it cuts the" << std::endl;
+  std::cout << "maze into over the threads given by --threads. We have "
+            << "also provided an" << std::endl;
+  std::cout << "iterative solution where you may specify this with the "
+            << "flag --gs. This flag" << std::endl;
+  std::cout << "behaves the same as --g except that it runs on a single "
+            << "stack. Both give the" << std::endl;
+  std::cout << "same maze for the same seed. --gwb also gives the same "
+            << "maze, on a single" << std::endl;
+  std::cout << "thread, by starting from a fully open maze and building "
+            << "each wall 64 cells" << std::endl;
+  std::cout << "at a time." << std::endl << std::endl;
+  std::cout << "\t--cutoff cells, where regions of fewer cells than this "
+            << "are divided by the" << std::endl;
+  std::cout << "\t\tthread that reached them rather than shared out as "
+            << "tasks by --g commands" << std::endl;
+  std::cout << "\t\tafter it. The default is "
+            << mazer2018::generators::recursivegen::DEFAULT_CUTOFF << "."
+            << std::endl
+            << std::endl;
+  std::cout << "\t--gl seed width height, which gives the same maze as "
+            << "--g but never" << std::endl;
+  std::cout << "\t\tgenerates it in full. Each 64x64 tile is worked out "
+            << "when it is first" << std::endl;
+  std::cout << "\t\tread and only the tiles read most recently are "
+            << "kept, so the maze is" << std::endl;
+  std::cout << "\t\tready at once whatever its size. It always uses the "
+            << "tiled64 layout." << std::endl;
+  std::cout << "\t--tiles n, where n is the most tiles the --gl commands "
+            << "after it keep at" << std::endl;
+  std::cout << "\t\tonce. The default is "
+            << mazer2018::generators::procedural_generator::DEFAULT_TILES
+            << "." << std::endl
+            << std::endl;
+
+  // provide help for the growing tree command
+  std::cout << "The growing tree generator can pick the cell it grows "
+            << "from in several ways:" << std::endl
+            << std::endl;
+  std::cout << "\t--gt policy seed width height, where policy is newest "
+            << "(the same as --gr)," << std::endl;
+  std::cout << "\t\trandom (the same as --gp), oldest, mixed:percent or "
+            << "window:size." << std::endl;
+  std::cout << "\t\tmixed takes the newest cell for percent of picks and "
+            << "a random one" << std::endl;
+  std::cout << "\t\totherwise; window takes a random one of the newest "
+            << "size cells." << std::endl
+            << std::endl;
+
+  // provide help for the kruskal command
+  std::cout << "Kruskal's algorithm knocks down walls in a random order "
+            << "wherever the cells on" << std::endl;
+  std::cout << "either side are not yet joined:" << std::endl << std::endl;
+  std::cout << "\t--gk seed width height, which spreads both the shuffle "
+            << "and the merge" << std::endl;
+  std::cout << "\t\tover the threads given by --threads and gives the "
+            << "same maze for any" << std::endl;
+  std::cout << "\t\tnumber of them." << std::endl << std::endl;
+
+  // provide help for the wilson command
+  std::cout << "Wilson's algorithm generates unbiased mazes, where every "
+            << "maze of the size is" << std::endl;
+  std::cout << "equally likely:" << std::endl << std::endl;
+  std::cout << "\t--gw seed width height, which always runs on a single "
+            << "thread." << std::endl
+            << std::endl;
+
+  // provide help for the eller command
+  std::cout << "Eller's algorithm generates a maze a row at a time and "
+            << "can write it out as it" << std::endl;
+  std::cout << "goes, so that only one row is ever held in memory:"
+            << std::endl
+            << std::endl;
+  std::cout << "\t--ge seed width height, where any --sb and --sv "
+            << "commands straight after it" << std::endl;
+  std::cout << "\t\tare written while the maze is generated. The maze "
+            << "is then not kept" << std::endl;
+  std::cout << "\t\tfor later commands, and it may be taller than "
+            << "100000, up to ten billion" << std::endl;
+  std::cout << "\t\tcells in all." << std::endl
+            << std::endl;
+
+  // provide help for the binary tree and sidewinder commands
+  std::cout << "The binary tree and sidewinder algorithms decide each "
+            << "cell on its own, 64" << std::endl;
+  std::cout << "cells at a time, for very large mazes generated very "
+            << "quickly:" << std::endl
+            << std::endl;
+  std::cout << "\t--gb seed width height, where every cell opens a "
+            << "passage east or south," << std::endl;
+  std::cout << "\t\twhich gives a strong diagonal grain." << std::endl;
+  std::cout << "\t--gsw seed width height, where each row is cut into "
+            << "runs that each open" << std::endl;
+  std::cout << "\t\tone passage south, which gives a vertical grain."
+            << std::endl;
+  std::cout << "\t\tBoth write any --sb and --sv commands straight after "
+            << "them while the maze" << std::endl;
+  std::cout << "\t\tis generated, the same as --ge." << std::endl
+            << std::endl;
+
+  // provide help for the threads command
+  std::cout << "Generation can be spread over several threads:" << std::endl
+            << std::endl;
+  std::cout << "\t--threads n, where n is the number of threads the "
+            << "generate commands after" << std::endl;
+  std::cout << "\t\tit use, or 0 for one per core. Every generator "
+            << "gives the same maze" << std::endl;
+  std::cout << "\t\tfor any number of threads. The parallel and fill "
+            << "solvers of the --pm" << std::endl;
+  std::cout << "\t\tcommands after it use the same number of threads."
+            << std::endl;
+  std::cout << "\t--tiled, which builds a growing tree maze 384 or more "
+            << "cells wide or high" << std::endl;
+  std::cout << "\t\tfrom tiles that are joined together, so that "
+            << "--threads can spread it" << std::endl;
+  std::cout << "\t\tover several threads, for the generate commands "
+            << "after it. Without it" << std::endl;
+  std::cout << "\t\tthe maze grows from a single frontier."
+            << std::endl
+            << std::endl;
+
+  // provide help for the batch command
+  std::cout << "Many mazes can be generated in one go, one for each seed "
+            << "of a range:" << std::endl
+            << std::endl;
+  std::cout << "\t--batch from to, where the generate command after it "
+            << "generates a maze" << std::endl;
+  std::cout << "\t\tfor every seed from from to to, spread over the "
+            << "threads given by" << std::endl;
+  std::cout << "\t\t--threads. Any seed it is given is ignored. The "
+            << "--sb and --sv commands" << std::endl;
+  std::cout << "\t\tstraight after it save every maze, to a file named "
+            << "with {seed}" << std::endl;
+  std::cout << "\t\treplaced by its seed - for example --sb "
+            << "maze{seed}.maze." << std::endl
+            << std::endl;
 
   // provide help for the load command
   std::cout << "You may also specify a load command which is specified "
@@ -100,7 +233,73 @@ void display_usage(void) {
             << "extension. " << std::endl
             << std::endl;
 
+  // provide help for the layout command
+  std::cout << "You may choose how the cells of the maze are stored in "
+            << "memory. A maze that" << std::endl;
+  std::cout << "has already been generated or loaded is converted: "
+            << std::endl << std::endl;
+  std::cout << "\t--layout name, where name is one of row (the default), "
+            << "tiled8, tiled64" << std::endl;
+  std::cout << "\t\tor morton. The tiled and morton layouts keep cells "
+            << "that are close" << std::endl;
+  std::cout << "\t\tin both directions close in memory. A loaded maze "
+            << "keeps the layout" << std::endl;
+  std::cout << "\t\tit was saved with unless you convert it." << std::endl
+            << std::endl;
+
+  // provide help for the mask command
+  std::cout << "A maze may be cut out of a shape given as a pbm bitmap:"
+            << std::endl
+            << std::endl;
+  std::cout << "\t--mask shape.pbm, where the next maze generated takes "
+            << "the size of the" << std::endl;
+  std::cout << "\t\tbitmap and fills its black pixels. Only memory for "
+            << "the shape is" << std::endl;
+  std::cout << "\t\tused, which works best with the tiled64 or morton "
+            << "layout." << std::endl
+            << std::endl;
+
+  // provide help for the map file command
+  std::cout << "A very large maze may be held in a memory mapped file "
+            << "rather than in memory:" << std::endl
+            << std::endl;
+  std::cout << "\t--mm somemazefile, where \"somemazefile\" is created "
+            << "and holds the current" << std::endl;
+  std::cout << "\t\tmaze and any maze generated after it. The file is a "
+            << "binary maze file" << std::endl;
+  std::cout << "\t\tthat --lb maps straight back into memory." << std::endl
+            << std::endl;
+
   // provide help for the save binary command.
+  // provide help for the path finding commands
+  std::cout << "You may find a path through the maze, which is marked on "
+            << "any svg file saved" << std::endl;
+  std::cout << "after it:" << std::endl << std::endl;
+  std::cout << "\t--pm, which finds a path from the first cell of the "
+            << "maze to the last, or" << std::endl;
+  std::cout << "\t--pm sx sy fx fy, which finds a path from the cell at "
+            << "sx, sy to the cell at" << std::endl;
+  std::cout << "\t\tfx, fy." << std::endl;
+  std::cout << "\t--solver name, where name is the search the --pm "
+            << "commands after it use:" << std::endl;
+  std::cout << "\t\tdfs (the default), a depth first search, bfs, a "
+            << "breadth first search" << std::endl;
+  std::cout << "\t\tthat finds a shortest path, astar, an A* search "
+            << "that finds a shortest" << std::endl;
+  std::cout << "\t\tpath while heading for the finish, bidir, a "
+            << "breadth first search" << std::endl;
+  std::cout << "\t\tfrom both ends at once that finds a shortest path "
+            << "where they meet," << std::endl;
+  std::cout << "\t\tparallel, a breadth first search spread over the "
+            << "threads given by" << std::endl;
+  std::cout << "\t\t--threads that finds a shortest path, or fill, "
+            << "which fills in dead ends" << std::endl;
+  std::cout << "\t\tuntil only the path is left, over the threads "
+            << "given by --threads." << std::endl;
+  std::cout << "\t\tfill reads the whole maze, so it can't solve a --gl "
+            << "maze." << std::endl
+            << std::endl;
+
   std::cout << "You may also save a maze in binary format. A command to "
             << "do this should be of" << std::endl;
   std::cout << "the following form: " << std::endl << std::endl;
@@ -0,0 +1,55 @@
+#include "astar_solver.h"
+#include <cstdlib>
+
+mazer2018::solvers::astar_solver::astar_solver(const data::maze& m,
+                                               data::arena& scratch)
+    : _maze(m), _marks(scratch), _open(scratch, SPAN), _explored(0) {}
+
+/**
+ * @param start the cell to start from
+ * @param goal the cell to find a path to
+ * @param path set to the path found
+ **/
+bool mazer2018::solvers::astar_solver::solve(
+    data::cell_id start, data::cell_id goal,
+    std::vector<data::cell_id>& path) {
+  path.clear();
+  _explored = 0;
+  _marks.reset(_maze);
+  const int goal_x = _maze.x_of(goal), goal_y = _maze.y_of(goal);
+  auto distance = [&](int x, int y) {
+    return std::size_t(std::abs(x - goal_x)) +
+           std::size_t(std::abs(y - goal_y));
+  };
+  const int start_x = _maze.x_of(start), start_y = _maze.y_of(start);
+  _open.clear(distance(start_x, start_y));
+  // the start has no parent, and is never followed back past
+  _open.push(distance(start_x, start_y),
+             node{std::uint64_t(start) << 2 |
+                      std::uint64_t(data::direction::NORTH),
+                  start_x, start_y});
+  while (!_open.empty()) {
+    std::size_t priority;
+    const node current = _open.pop(priority);
+    const data::cell_id cell = data::cell_id(current.cell >> 2);
+    // a cell queued more than once is only expanded the first time
+    if (_marks.visited(cell)) continue;
+    _marks.visit(cell, data::direction(current.cell & 3));
+    ++_explored;
+    if (cell == goal) {
+      _marks.trace(_maze, start, goal, path);
+      return true;
+    }
+    const std::size_t here = distance(current.x, current.y);
+    _maze.for_each_neighbour(
+        cell, [&](data::cell_id next, data::direction dir) {
+          if (_marks.visited(next)) return;
+          const int x = current.x + data::dir_dx[int(dir)],
+                    y = current.y + data::dir_dy[int(dir)];
+          // one step closer keeps the priority, one further adds two
+          _open.push(distance(x, y) < here ? priority : priority + 2,
+                     node{std::uint64_t(next) << 2 | std::uint64_t(!dir), x, y});
+        });
+  }
+  return false;
+}
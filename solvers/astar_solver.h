@@ -0,0 +1,71 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../data/arena.h"
+#include "../data/bucket_queue.h"
+#include "../data/maze.h"
+#include "search_marks.h"
+
+#pragma once
+namespace mazer2018 {
+namespace solvers {
+/**
+ * finds a shortest path between two cells with an A* search, guided
+ * towards the goal by the manhattan distance to it. Cells are expanded in
+ * order of the length of the path through them to the start plus that
+ * distance on to the goal, so the search heads for the goal and, on a
+ * maze with loops, explores far less of it than a breadth first search.
+ *
+ * Every step costs one and moves one closer to the goal or one further
+ * away, so the priority of a cell reached is either that of the cell it
+ * was reached from or two more. The open cells are therefore held in a
+ * @ref data::bucket_queue of three buckets rather than a heap. The
+ * closed cells and the way back from each are held in @ref search_marks;
+ * a cell may be queued more than once, once for each neighbour that
+ * reaches it before it is closed, and only the first to come out counts.
+ **/
+class astar_solver {
+  /// a cell waiting to be expanded
+  struct node {
+    /// the handle of the cell shifted up two bits, with the direction
+    /// back to the cell it was reached from below
+    std::uint64_t cell;
+    /// the position of the cell
+    std::int32_t x, y;
+  };
+
+  /// the maze to search
+  const data::maze& _maze;
+  /// which cells have been closed and how they were reached
+  search_marks _marks;
+  /// the cells reached but not yet closed, by priority
+  data::bucket_queue<node> _open;
+  /// the number of cells expanded by the last search
+  std::size_t _explored;
+
+  /// the most a priority grows by in one step, plus one
+  static const std::size_t SPAN = 3;
+
+ public:
+  /**
+   * @param m the maze to search
+   * @param scratch where the state of the search is allocated from
+   **/
+  astar_solver(const data::maze& m, data::arena& scratch);
+
+  /**
+   * finds a shortest path from start to goal
+   * @param path set to the cells of the path from start to goal inclusive
+   * @return false if the goal can't be reached from the start, in which
+   * case the path is left empty
+   **/
+  bool solve(data::cell_id start, data::cell_id goal,
+             std::vector<data::cell_id>& path);
+
+  /**
+   * @return the number of cells the last search expanded
+   **/
+  std::size_t explored(void) const { return _explored; }
+};
+}  // namespace solvers
+}  // namespace mazer2018
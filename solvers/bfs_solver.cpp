@@ -0,0 +1,37 @@
+#include "bfs_solver.h"
+
+mazer2018::solvers::bfs_solver::bfs_solver(const data::maze& m,
+                                           data::arena& scratch)
+    : _maze(m), _marks(scratch), _queue(scratch), _explored(0) {}
+
+/**
+ * @param start the cell to start from
+ * @param goal the cell to find a path to
+ * @param path set to the path found
+ **/
+bool mazer2018::solvers::bfs_solver::solve(data::cell_id start,
+                                           data::cell_id goal,
+                                           std::vector<data::cell_id>& path) {
+  path.clear();
+  _explored = 0;
+  _marks.reset(_maze);
+  _queue.clear();
+  // the start has no parent, and is never followed back past
+  _marks.visit(start, data::direction::NORTH);
+  _queue.push(start);
+  while (!_queue.empty()) {
+    const data::cell_id cell = _queue.pop();
+    ++_explored;
+    if (cell == goal) {
+      _marks.trace(_maze, start, goal, path);
+      return true;
+    }
+    _maze.for_each_neighbour(
+        cell, [&](data::cell_id next, data::direction dir) {
+          if (_marks.visited(next)) return;
+          _marks.visit(next, !dir);
+          _queue.push(next);
+        });
+  }
+  return false;
+}
@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <vector>
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/ring_queue.h"
+#include "search_marks.h"
+
+#pragma once
+namespace mazer2018 {
+namespace solvers {
+/**
+ * finds a shortest path between two cells with a breadth first search.
+ * Cells are taken in the order they are reached, so the first time the
+ * goal is reached it is by a path with as few steps as any - which
+ * matters once a maze has loops, where a depth first search finds a path
+ * but not a shortest one.
+ *
+ * The frontier is a @ref data::ring_queue of cell handles and everything
+ * else the search knows is held in @ref search_marks, so a search costs
+ * three bits a cell plus the widest frontier, all of it allocated from
+ * an arena and reused by every search made with the solver. Over a sparse
+ * or procedural maze it only costs memory for the cells it reaches.
+ **/
+class bfs_solver {
+  /// the maze to search
+  const data::maze& _maze;
+  /// which cells have been reached and how
+  search_marks _marks;
+  /// the cells reached but not yet expanded, in the order they were
+  /// reached
+  data::ring_queue<data::cell_id> _queue;
+  /// the number of cells expanded by the last search
+  std::size_t _explored;
+
+ public:
+  /**
+   * @param m the maze to search
+   * @param scratch where the state of the search is allocated from
+   **/
+  bfs_solver(const data::maze& m, data::arena& scratch);
+
+  /**
+   * finds a shortest path from start to goal
+   * @param path set to the cells of the path from start to goal inclusive
+   * @return false if the goal can't be reached from the start, in which
+   * case the path is left empty
+   **/
+  bool solve(data::cell_id start, data::cell_id goal,
+             std::vector<data::cell_id>& path);
+
+  /**
+   * @return the number of cells the last search expanded
+   **/
+  std::size_t explored(void) const { return _explored; }
+};
+}  // namespace solvers
+}  // namespace mazer2018
@@ -0,0 +1,110 @@
+#include "bidirectional_solver.h"
+#include <algorithm>
+
+mazer2018::solvers::bidirectional_solver::bidirectional_solver(
+    const data::maze& m, data::arena& scratch)
+    : _maze(m),
+      _stamps(data::arena_allocator<std::uint8_t>(scratch)),
+      _sparse(false),
+      _stamp(MAX_STAMP),
+      _fronts{data::ring_queue<data::cell_id>(scratch),
+              data::ring_queue<data::cell_id>(scratch)},
+      _explored(0) {}
+
+/**
+ * each walk takes two stamps, so the stamps only need clearing for real
+ * when they run out or the maze changes between dense and sparse
+ **/
+void mazer2018::solvers::bidirectional_solver::reset(void) {
+  _stamp += 2;
+  // a procedural maze may be far too big for a stamp per cell
+  if (_maze.sparse() || _maze.procedural()) {
+    if (!_sparse || _stamp > MAX_STAMP) {
+      // the dense stamps are no longer needed so give their memory back
+      data::arena_vector<std::uint8_t>(_stamps.get_allocator())
+          .swap(_stamps);
+      _sparse_stamps.clear();
+      _sparse = true;
+      _stamp = 1;
+    }
+  } else {
+    const std::size_t cells = std::size_t(_maze.capacity());
+    if (_sparse || _stamps.size() != cells || _stamp > MAX_STAMP) {
+      _sparse_stamps.clear();
+      _sparse = false;
+      _stamps.assign(cells, 0);
+      _stamp = 1;
+    }
+  }
+  _fronts[0].clear();
+  _fronts[1].clear();
+}
+
+/**
+ * @param cell the cell to start from
+ * @param end the cell the search that reached it started from
+ * @param path where the cells are appended
+ **/
+void mazer2018::solvers::bidirectional_solver::trace(
+    data::cell_id cell, data::cell_id end,
+    std::vector<data::cell_id>& path) const {
+  path.push_back(cell);
+  while (cell != end) {
+    cell = _maze.neighbour(
+        cell, data::direction(stamp(cell) & ((1 << DIR_BITS) - 1)));
+    path.push_back(cell);
+  }
+}
+
+/**
+ * @param start the cell to start from
+ * @param goal the cell to find a path to
+ * @param path set to the path found
+ **/
+bool mazer2018::solvers::bidirectional_solver::solve(
+    data::cell_id start, data::cell_id goal,
+    std::vector<data::cell_id>& path) {
+  path.clear();
+  _explored = 0;
+  reset();
+  if (start == goal) {
+    path.push_back(start);
+    return true;
+  }
+  const data::cell_id ends[2] = {start, goal};
+  for (int s = 0; s < 2; ++s) {
+    // neither end has a parent, and is never followed back past
+    visit(ends[s], s, data::direction::NORTH);
+    _fronts[s].push(ends[s]);
+  }
+  while (!_fronts[0].empty() && !_fronts[1].empty()) {
+    // expand a whole level of the smaller frontier
+    const int s = _fronts[1].size() < _fronts[0].size() ? 1 : 0;
+    data::ring_queue<data::cell_id>& front = _fronts[s];
+    data::cell_id meet[2] = {constants::ERROR, constants::ERROR};
+    for (std::size_t level = front.size(); level && meet[s] < 0; --level) {
+      const data::cell_id cell = front.pop();
+      ++_explored;
+      _maze.for_each_neighbour(
+          cell, [&](data::cell_id next, data::direction dir) {
+            if (meet[s] >= 0) return;
+            const int reached = side(next);
+            if (reached < 0) {
+              visit(next, s, !dir);
+              front.push(next);
+            } else if (reached != s) {
+              meet[s] = cell;
+              meet[1 - s] = next;
+            }
+          });
+    }
+    if (meet[s] >= 0) {
+      // the way back to the start, turned round, then on to the goal
+      trace(meet[0], start, path);
+      std::reverse(path.begin(), path.end());
+      trace(meet[1], goal, path);
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,126 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/ring_queue.h"
+#include "../data/sparse_array.h"
+
+#pragma once
+namespace mazer2018 {
+namespace solvers {
+/**
+ * finds a shortest path between two cells with a pair of breadth first
+ * searches, one from each end, that stop when they meet. Each step
+ * expands a whole level of whichever search has the smaller frontier, so
+ * neither search gets far ahead of the other. Between two cells far
+ * apart each search only covers about half of what a search from one end
+ * would before they meet.
+ *
+ * The first passage found between a cell of one search and a cell of the
+ * other is on a shortest path: expanding a level never finds a cell the
+ * other search reached before its own current level, as that cell would
+ * already have been found by it. The path is the way back from each end
+ * of that passage spliced together.
+ *
+ * Both searches stamp the cells they reach in one shared array, a byte a
+ * cell: which search reached the cell and in which walk, and the
+ * direction back to the cell it was reached from. A cell stamped by the
+ * other search in the current walk is where they meet. Starting a new
+ * walk moves to new stamps rather than clearing the array. Over a sparse
+ * or procedural maze the stamps are kept in a @ref data::sparse_array, so
+ * their memory follows the cells reached rather than the size of the
+ * maze.
+ **/
+class bidirectional_solver {
+  /// the maze to search
+  const data::maze& _maze;
+  /// the stamp of each cell, indexed by handle - the search that reached
+  /// it in the top 6 bits and the direction back to its parent below
+  data::arena_vector<std::uint8_t> _stamps;
+  /// the stamps of a search over a sparse maze, one 64x64 tile to a chunk
+  /// in the tiled layouts
+  data::sparse_array<std::uint8_t, 12> _sparse_stamps;
+  /// whether the stamps are held in @ref _sparse_stamps
+  bool _sparse;
+  /// the stamp of the search from the start in the current walk. The
+  /// search from the goal uses the next stamp up.
+  std::uint8_t _stamp;
+  /// the frontiers of the search from the start and from the goal
+  data::ring_queue<data::cell_id> _fronts[2];
+  /// the number of cells expanded by the last search
+  std::size_t _explored;
+
+  /// the number of bits of a stamp that hold the parent direction
+  static const int DIR_BITS = 2;
+  /// the largest stamp of the search from the start that leaves room for
+  /// the search from the goal
+  static const std::uint8_t MAX_STAMP = (0xff >> DIR_BITS) - 1;
+
+  /**
+   * @return the stamp of a cell
+   **/
+  std::uint8_t stamp(data::cell_id id) const {
+    return _sparse ? _sparse_stamps.get(std::size_t(id)) : _stamps[id];
+  }
+
+  /**
+   * @return a reference to the stamp of a cell
+   **/
+  std::uint8_t& stamp(data::cell_id id) {
+    return _sparse ? _sparse_stamps.touch(std::size_t(id)) : _stamps[id];
+  }
+
+  /**
+   * starts a new walk in which no cell has been reached
+   **/
+  void reset(void);
+
+  /**
+   * @return the search that reached a cell in the current walk - 0 for
+   * the start and 1 for the goal - or -1 if neither has
+   **/
+  int side(data::cell_id id) const {
+    const int side = (stamp(id) >> DIR_BITS) - _stamp;
+    return side == 0 || side == 1 ? side : -1;
+  }
+
+  /**
+   * marks a cell as reached by a search
+   * @param parent the direction from the cell back to the cell it was
+   * reached from
+   **/
+  void visit(data::cell_id id, int side, data::direction parent) {
+    stamp(id) = std::uint8_t(((_stamp + side) << DIR_BITS) | int(parent));
+  }
+
+  /**
+   * follows the parents back from a cell to the end its search started
+   * from, appending each cell to the path
+   **/
+  void trace(data::cell_id cell, data::cell_id end,
+             std::vector<data::cell_id>& path) const;
+
+ public:
+  /**
+   * @param m the maze to search
+   * @param scratch where the state of the search is allocated from
+   **/
+  bidirectional_solver(const data::maze& m, data::arena& scratch);
+
+  /**
+   * finds a shortest path from start to goal
+   * @param path set to the cells of the path from start to goal inclusive
+   * @return false if the goal can't be reached from the start, in which
+   * case the path is left empty
+   **/
+  bool solve(data::cell_id start, data::cell_id goal,
+             std::vector<data::cell_id>& path);
+
+  /**
+   * @return the number of cells the last search expanded, from both ends
+   **/
+  std::size_t explored(void) const { return _explored; }
+};
+}  // namespace solvers
+}  // namespace mazer2018
@@ -0,0 +1,205 @@
+#include "dead_end_solver.h"
+#include <algorithm>
+#include "../data/parallel.h"
+
+mazer2018::solvers::dead_end_solver::dead_end_solver(const data::maze& m,
+                                                     data::arena& scratch,
+                                                     unsigned threads)
+    : _maze(m),
+      _threads(data::thread_count(threads)),
+      _row_words((std::size_t(m.width()) + 63) / 64),
+      _east(data::arena_allocator<std::uint64_t>(scratch)),
+      _south(data::arena_allocator<std::uint64_t>(scratch)),
+      _open(data::arena_allocator<std::uint64_t>(scratch)),
+      _work(data::arena_allocator<std::size_t>(scratch)),
+      _next(data::arena_allocator<std::size_t>(scratch)),
+      _found(data::arena_allocator<std::uint64_t>(scratch)),
+      _queued(data::arena_allocator<std::uint64_t>(scratch)),
+      _ends{0, 0},
+      _marks(scratch),
+      _queue(scratch),
+      _filled(0),
+      _explored(0) {}
+
+/**
+ * the bits past the last column of each row are left closed, so they are
+ * never a neighbour of anything
+ **/
+void mazer2018::solvers::dead_end_solver::load(void) {
+  const std::size_t words = _row_words * std::size_t(_maze.height());
+  _east.resize(words);
+  _south.resize(words);
+  for (int y = 0; y < _maze.height(); ++y) {
+    _maze.read_row(y, &_east[std::size_t(y) * _row_words],
+                   &_south[std::size_t(y) * _row_words]);
+  }
+  _open.assign(words, ~std::uint64_t(0));
+  if (_maze.width() & 63) {
+    const std::uint64_t end =
+        ~std::uint64_t(0) >> (64 - (_maze.width() & 63));
+    for (std::size_t word = _row_words - 1; word < words;
+         word += _row_words) {
+      _open[word] = end;
+    }
+  }
+  _queued.assign((words + 63) / 64, 0);
+}
+
+/**
+ * @param word the index of the word in the bitmaps
+ **/
+std::uint64_t mazer2018::solvers::dead_end_solver::dead_ends(
+    std::size_t word) const {
+  std::uint64_t open = _open[word];
+  if (!open) return 0;
+  const std::size_t column = word % _row_words;
+  const bool first_row = word < _row_words;
+  const bool last_row = word + _row_words >= _open.size();
+  // the open cells and passages of the words either side
+  const std::uint64_t open_before = column ? _open[word - 1] : 0;
+  const std::uint64_t open_after =
+      column + 1 < _row_words ? _open[word + 1] : 0;
+  const std::uint64_t east_before = column ? _east[word - 1] : 0;
+  const std::uint64_t south =
+      last_row ? 0 : _south[word] & _open[word + _row_words];
+  const std::uint64_t north = first_row ? 0
+                                        : _south[word - _row_words] &
+                                              _open[word - _row_words];
+  std::uint64_t keep = 0;
+  for (std::size_t end : _ends) {
+    if (end >> 6 == word) keep |= std::uint64_t(1) << (end & 63);
+  }
+  // filling a cell can leave its neighbours in the word with one open
+  // side, so a corridor along the row is filled in one go
+  std::uint64_t found = 0;
+  for (;;) {
+    // the sides of each cell that lead east and west to an open cell
+    const std::uint64_t east = _east[word] & (open >> 1 | open_after << 63);
+    const std::uint64_t west = (_east[word] << 1 | east_before >> 63) &
+                               (open << 1 | open_before >> 63);
+    // the cells with two open sides or more: both east and west, both
+    // north and south, or one of each
+    const std::uint64_t two = (east & west) | (north & south) |
+                              ((east ^ west) & (north ^ south));
+    const std::uint64_t dead = open & ~two & ~keep;
+    if (!dead) return found;
+    found |= dead;
+    open &= ~dead;
+  }
+}
+
+/**
+ * @param word the index of the word in the bitmaps
+ **/
+void mazer2018::solvers::dead_end_solver::queue(std::size_t word) {
+  std::uint64_t& bit = _queued[word >> 6];
+  const std::uint64_t mask = std::uint64_t(1) << (word & 63);
+  if (bit & mask) return;
+  bit |= mask;
+  _next.push_back(word);
+}
+
+/**
+ * @param word the index of the word in the bitmaps
+ * @param found the cells of the word to fill
+ **/
+void mazer2018::solvers::dead_end_solver::fill(std::size_t word,
+                                               std::uint64_t found) {
+  const std::size_t column = word % _row_words;
+  _open[word] &= ~found;
+  _filled += std::size_t(__builtin_popcountll(found));
+  // the words with cells that lost an open side - the word itself has no
+  // dead ends left until one of them is filled
+  if ((found & 1) && column) queue(word - 1);
+  if ((found >> 63) && column + 1 < _row_words) queue(word + 1);
+  if (word >= _row_words) queue(word - _row_words);
+  if (word + _row_words < _open.size()) queue(word + _row_words);
+}
+
+/**
+ * the first pass streams through every word. Later passes are made while
+ * there are enough words to share out, after which the worklist is worked
+ * through as a stack, filling each word as soon as it is looked at so
+ * that a corridor down the columns is filled in one go too.
+ **/
+void mazer2018::solvers::dead_end_solver::fill(void) {
+  _work.resize(_open.size());
+  for (std::size_t word = 0; word < _work.size(); ++word) _work[word] = word;
+  for (bool first = true;
+       first || (_threads > 1 && _work.size() >= _threads * TASK_WORDS);
+       first = false) {
+    // every dead end of the pass is found before any is filled, so the
+    // threads only read the bitmaps. The worklist is in row order, so each
+    // task is a band of rows.
+    _found.resize(_work.size());
+    const std::size_t tasks = (_work.size() + TASK_WORDS - 1) / TASK_WORDS;
+    data::parallel_for(_threads, tasks, [this](std::size_t task, unsigned) {
+      const std::size_t last =
+          std::min(_work.size(), (task + 1) * TASK_WORDS);
+      for (std::size_t i = task * TASK_WORDS; i < last; ++i) {
+        _found[i] = dead_ends(_work[i]);
+      }
+    });
+    _next.clear();
+    for (std::size_t word : _work) {
+      _queued[word >> 6] &= ~(std::uint64_t(1) << (word & 63));
+    }
+    for (std::size_t i = 0; i < _work.size(); ++i) {
+      if (_found[i]) fill(_work[i], _found[i]);
+    }
+    std::sort(_next.begin(), _next.end());
+    _work.swap(_next);
+  }
+  _next.swap(_work);
+  while (!_next.empty()) {
+    const std::size_t word = _next.back();
+    _next.pop_back();
+    _queued[word >> 6] &= ~(std::uint64_t(1) << (word & 63));
+    const std::uint64_t found = dead_ends(word);
+    if (found) fill(word, found);
+  }
+}
+
+/**
+ * @param start the cell to start from
+ * @param goal the cell to find a path to
+ * @param path set to the path found
+ **/
+bool mazer2018::solvers::dead_end_solver::solve(
+    data::cell_id start, data::cell_id goal,
+    std::vector<data::cell_id>& path) {
+  path.clear();
+  _filled = _explored = 0;
+  const data::cell_id ends[2] = {start, goal};
+  for (int end = 0; end < 2; ++end) {
+    _ends[end] =
+        std::size_t(_maze.y_of(ends[end])) * _row_words * 64 +
+        std::size_t(_maze.x_of(ends[end]));
+  }
+  load();
+  fill();
+  // a breadth first search over the cells left, which in a perfect maze
+  // is a walk along the path
+  _marks.reset(_maze);
+  _queue.clear();
+  _marks.visit(start, data::direction::NORTH);
+  _queue.push(start);
+  while (!_queue.empty()) {
+    const data::cell_id cell = _queue.pop();
+    ++_explored;
+    if (cell == goal) {
+      _marks.trace(_maze, start, goal, path);
+      return true;
+    }
+    _maze.for_each_neighbour(
+        cell, [&](data::cell_id next, data::direction dir) {
+          if (_marks.visited(next) ||
+              !open(_maze.x_of(next), _maze.y_of(next))) {
+            return;
+          }
+          _marks.visit(next, !dir);
+          _queue.push(next);
+        });
+  }
+  return false;
+}
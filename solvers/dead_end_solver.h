@@ -0,0 +1,147 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/ring_queue.h"
+#include "search_marks.h"
+
+#pragma once
+namespace mazer2018 {
+namespace solvers {
+/**
+ * solves a maze by dead end filling rather than by searching: a cell
+ * other than the start or the goal with at most one open side to a cell
+ * that hasn't been filled can't be on a path between them, so it is
+ * filled, until there are none left. What is left of a perfect maze is
+ * the path itself, and of a braided one the path and any loops it passes
+ * through, which a breadth first search over the cells left then walks.
+ *
+ * The passages are copied out of the maze into bitmaps with a bit a cell,
+ * each row starting at a new word, alongside a bitmap of the cells not yet
+ * filled. The open sides of a word of 64 cells are then the passage words
+ * masked with the words of the cells either side, shifted a bit along for
+ * east and west, and the cells with at most one are found with a handful
+ * of ands and ors on those four words rather than a cell at a time.
+ *
+ * Filling is driven by a worklist of words, each of which is filled until
+ * it has no dead ends left. Every word is in the first pass, which
+ * streams through the whole maze, and afterwards a word is only looked at
+ * again once a cell next to it has been filled. While the worklist is big
+ * it is worked through in passes: a pass finds the dead ends of every word
+ * in it before any are filled, so the worklist is shared out in bands of
+ * rows over the threads given, and the threads only ever read the
+ * bitmaps. Filling every dead end found at once is safe, as none of them
+ * can be on a path between the ends.
+ *
+ * The cells filled are kept once the maze is solved, as a map of the
+ * dead ends of the maze.
+ *
+ * Filling needs every passage of the maze, so it mustn't be given a
+ * procedural maze, which would have every tile of it worked out. A
+ * masked maze is filled like any other, with bitmaps the size of its
+ * mask, and its cells outside the mask are filled in the first pass.
+ **/
+class dead_end_solver {
+  /// the maze to solve
+  const data::maze& _maze;
+  /// the number of threads to find dead ends on
+  unsigned _threads;
+  /// the number of words in each row of the bitmaps
+  std::size_t _row_words;
+  /// the passages east and south of each cell, a row at a time
+  data::arena_vector<std::uint64_t> _east, _south;
+  /// the cells that haven't been filled, laid out as the passages
+  data::arena_vector<std::uint64_t> _open;
+  /// the words to look through in the current pass and the next, or the
+  /// worklist once it is worked through as a stack
+  data::arena_vector<std::size_t> _work, _next;
+  /// the dead ends found in each word of the current pass
+  data::arena_vector<std::uint64_t> _found;
+  /// a bit for each word that is in the worklist of the next pass
+  data::arena_vector<std::uint64_t> _queued;
+  /// the bits of the start and the goal in the bitmaps, which are never
+  /// filled
+  std::size_t _ends[2];
+  /// the marks and the frontier of the walk along what is left
+  search_marks _marks;
+  data::ring_queue<data::cell_id> _queue;
+  /// the number of cells filled and expanded by the last solve
+  std::size_t _filled, _explored;
+
+  /// the number of words of a pass in each task
+  static const std::size_t TASK_WORDS = 4096;
+
+  /**
+   * @return whether a cell hasn't been filled
+   **/
+  bool open(int x, int y) const {
+    return _open[std::size_t(y) * _row_words + std::size_t(x >> 6)] >>
+               (x & 63) &
+           1;
+  }
+
+  /**
+   * copies the passages out of the maze and starts with every cell open
+   **/
+  void load(void);
+
+  /**
+   * @return the cells of a word of the bitmaps, other than the start and
+   * the goal, that are left with at most one open side by filling the
+   * others
+   **/
+  std::uint64_t dead_ends(std::size_t word) const;
+
+  /**
+   * adds a word to the worklist of the next pass unless it is there
+   **/
+  void queue(std::size_t word);
+
+  /**
+   * fills some of the cells of a word and queues the words next to them
+   **/
+  void fill(std::size_t word, std::uint64_t found);
+
+  /**
+   * fills dead ends until there are none left
+   **/
+  void fill(void);
+
+ public:
+  /**
+   * @param m the maze to solve
+   * @param scratch where the state of the solver is allocated from
+   * @param threads the number of threads to find dead ends on, or 0 for
+   * one per core
+   * @throw args::action_failed if the maze is procedural
+   **/
+  dead_end_solver(const data::maze& m, data::arena& scratch,
+                  unsigned threads);
+
+  /**
+   * finds a shortest path from start to goal
+   * @param path set to the cells of the path from start to goal inclusive
+   * @return false if the goal can't be reached from the start, in which
+   * case the path is left empty
+   **/
+  bool solve(data::cell_id start, data::cell_id goal,
+             std::vector<data::cell_id>& path);
+
+  /**
+   * @return whether the last solve filled the cell at x, y as a dead end
+   **/
+  bool dead_end(int x, int y) const { return !open(x, y); }
+
+  /**
+   * @return the number of cells the last solve filled
+   **/
+  std::size_t filled(void) const { return _filled; }
+
+  /**
+   * @return the number of cells the walk along what was left expanded
+   **/
+  std::size_t explored(void) const { return _explored; }
+};
+}  // namespace solvers
+}  // namespace mazer2018
@@ -0,0 +1,229 @@
+#include "parallel_bfs_solver.h"
+#include <algorithm>
+#include "../data/parallel.h"
+
+mazer2018::solvers::parallel_bfs_solver::parallel_bfs_solver(
+    const data::maze& m, data::arena& scratch, unsigned threads)
+    : _maze(m),
+      _threads(m.sparse() || m.masked() || m.procedural()
+                   ? 1
+                   : data::thread_count(threads)),
+      _visited(data::arena_allocator<std::uint64_t>(scratch)),
+      _front(data::arena_allocator<std::uint64_t>(scratch)),
+      _next(data::arena_allocator<std::uint64_t>(scratch)),
+      _levels(data::arena_allocator<std::uint32_t>(scratch)),
+      _sparse(m.sparse() || m.procedural()),
+      _in(0),
+      _starts(_threads + 1),
+      _found(_threads),
+      _next_task(0),
+      _tasks(0),
+      _frontier(0),
+      _reached(0),
+      _level(0),
+      _bottom_up(false),
+      _done(true),
+      _goal(constants::ERROR) {
+  _queues[0].resize(_threads);
+  _queues[1].resize(_threads);
+}
+
+/**
+ * @param task the task to expand - a run of @ref TASK_CELLS cells of the
+ * level, counting through the queues of the threads one after the other
+ * @param worker the thread expanding it, which queues the cells it claims
+ **/
+void mazer2018::solvers::parallel_bfs_solver::top_down(std::size_t task,
+                                                       unsigned worker) {
+  const std::vector<std::vector<data::cell_id> >& in = _queues[_in];
+  std::vector<data::cell_id>& out = _queues[1 - _in][worker];
+  const std::uint32_t level = _level + 1;
+  std::size_t pos = task * TASK_CELLS;
+  const std::size_t end = std::min(pos + TASK_CELLS, _frontier);
+  // the queue the task starts in
+  std::size_t queue =
+      std::size_t(std::upper_bound(_starts.begin(), _starts.end(), pos) -
+                  _starts.begin()) -
+      1;
+  for (; pos < end; ++pos) {
+    while (pos >= _starts[queue + 1]) ++queue;
+    _maze.for_each_neighbour(in[queue][pos - _starts[queue]],
+                             [&](data::cell_id next, data::direction) {
+                               if (claim(next, level)) out.push_back(next);
+                             });
+  }
+}
+
+/**
+ * @param task the task to look through - @ref TASK_WORDS words of the
+ * bitmaps, which no other task touches
+ * @param worker the thread looking through it
+ **/
+void mazer2018::solvers::parallel_bfs_solver::bottom_up(std::size_t task,
+                                                        unsigned worker) {
+  const std::uint32_t level = _level + 1;
+  const std::size_t first = task * TASK_WORDS;
+  const std::size_t last = std::min(first + TASK_WORDS, _visited.size());
+  std::size_t found = 0;
+  for (std::size_t word = first; word < last; ++word) {
+    std::uint64_t next = 0;
+    for (std::uint64_t left = ~_visited[word]; left; left &= left - 1) {
+      const data::cell_id id =
+          data::cell_id(word * 64 + std::size_t(__builtin_ctzll(left)));
+      for (int d = 0; d < data::num_dirs; ++d) {
+        const data::direction dir = data::direction(d);
+        if (!_maze.passage(id, dir)) continue;
+        const data::cell_id from = _maze.neighbour(id, dir);
+        if (_front[std::size_t(from) >> 6] >> (from & 63) & 1) {
+          next |= left & -left;
+          _levels[id] = level;
+          break;
+        }
+      }
+    }
+    _next[word] = next;
+    _visited[word] |= next;
+    found += std::size_t(__builtin_popcountll(next));
+  }
+  _found[worker] += found;
+}
+
+void mazer2018::solvers::parallel_bfs_solver::plan_level(void) {
+  if (_bottom_up) {
+    _tasks = (_visited.size() + TASK_WORDS - 1) / TASK_WORDS;
+  } else {
+    const std::vector<std::vector<data::cell_id> >& in = _queues[_in];
+    for (unsigned worker = 0; worker < _threads; ++worker) {
+      _starts[worker + 1] = _starts[worker] + in[worker].size();
+      _queues[1 - _in][worker].clear();
+    }
+    _tasks = (_frontier + TASK_CELLS - 1) / TASK_CELLS;
+  }
+  _next_task = 0;
+}
+
+/**
+ * the search switches direction on the sizes of the frontier and of what
+ * is left, as counted in cells rather than passages - every cell has at
+ * most four
+ **/
+void mazer2018::solvers::parallel_bfs_solver::next_level(void) {
+  ++_level;
+  _frontier = 0;
+  if (_bottom_up) {
+    for (std::size_t& found : _found) {
+      _frontier += found;
+      found = 0;
+    }
+    _front.swap(_next);
+  } else {
+    _in = 1 - _in;
+    for (const std::vector<data::cell_id>& queue : _queues[_in]) {
+      _frontier += queue.size();
+    }
+  }
+  _reached += _frontier;
+  if (!_frontier || (_goal >= 0 && visited(_goal))) {
+    _done = true;
+    return;
+  }
+  const std::size_t cells = std::size_t(_maze.capacity());
+  if (!_sparse && !_bottom_up && _frontier * ALPHA > cells - _reached) {
+    // the frontier becomes a bitmap
+    _front.assign(_visited.size(), 0);
+    _next.resize(_visited.size());
+    for (const std::vector<data::cell_id>& queue : _queues[_in]) {
+      for (data::cell_id id : queue) {
+        _front[std::size_t(id) >> 6] |= std::uint64_t(1) << (id & 63);
+      }
+    }
+    _bottom_up = true;
+  } else if (_bottom_up && _frontier * BETA < cells) {
+    // and back into a queue
+    for (std::vector<data::cell_id>& queue : _queues[_in]) queue.clear();
+    std::vector<data::cell_id>& queue = _queues[_in][0];
+    for (std::size_t word = 0; word < _front.size(); ++word) {
+      for (std::uint64_t bits = _front[word]; bits; bits &= bits - 1) {
+        queue.push_back(
+            data::cell_id(word * 64 + std::size_t(__builtin_ctzll(bits))));
+      }
+    }
+    _bottom_up = false;
+  }
+  plan_level();
+}
+
+/**
+ * @param start the cell to work out the distances from
+ * @param goal the cell to stop at, if any
+ **/
+std::size_t mazer2018::solvers::parallel_bfs_solver::distances(
+    data::cell_id start, data::cell_id goal) {
+  if (_sparse) {
+    _sparse_levels.clear();
+  } else {
+    const std::size_t cells = std::size_t(_maze.capacity());
+    _visited.assign((cells + 63) / 64, 0);
+    if (cells & 63) _visited.back() = ~std::uint64_t(0) << (cells & 63);
+    // a distance is only read once its cell is reached, so the distances
+    // of the last search are left to be written over
+    _levels.resize(cells);
+  }
+  for (int side = 0; side < 2; ++side) {
+    for (std::vector<data::cell_id>& queue : _queues[side]) queue.clear();
+  }
+  _in = 0;
+  claim(start, 0);
+  _queues[_in][0].push_back(start);
+  _frontier = _reached = 1;
+  _level = 0;
+  _bottom_up = false;
+  _goal = goal;
+  _done = start == goal;
+  plan_level();
+  data::barrier sync(_threads);
+  data::parallel_for(_threads, _threads, [&](std::size_t, unsigned worker) {
+    while (!_done) {
+      for (std::size_t task = _next_task++; task < _tasks;
+           task = _next_task++) {
+        if (_bottom_up) {
+          bottom_up(task, worker);
+        } else {
+          top_down(task, worker);
+        }
+      }
+      sync.wait([this] { next_level(); });
+    }
+  });
+  return _reached;
+}
+
+/**
+ * @param start the cell to start from
+ * @param goal the cell to find a path to
+ * @param path set to the path found
+ **/
+bool mazer2018::solvers::parallel_bfs_solver::solve(
+    data::cell_id start, data::cell_id goal,
+    std::vector<data::cell_id>& path) {
+  path.clear();
+  distances(start, goal);
+  if (!visited(goal)) return false;
+  // any neighbour a step nearer the start is on a shortest path
+  data::cell_id cell = goal;
+  path.push_back(cell);
+  while (cell != start) {
+    const std::uint32_t level = distance(cell) - 1;
+    for (int d = 0; d < data::num_dirs; ++d) {
+      if (!_maze.passage(cell, data::direction(d))) continue;
+      const data::cell_id next = _maze.neighbour(cell, data::direction(d));
+      if (visited(next) && distance(next) == level) {
+        cell = next;
+        break;
+      }
+    }
+    path.push_back(cell);
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
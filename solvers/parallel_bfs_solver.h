@@ -0,0 +1,200 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../constants/constants.h"
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/sparse_array.h"
+
+#pragma once
+namespace mazer2018 {
+namespace solvers {
+/**
+ * works out the distance from a cell to every cell it can reach with a
+ * breadth first search spread over several threads, and finds shortest
+ * paths from it. The search goes a level at a time - every cell the same
+ * number of steps from the start - and the threads share out the work of
+ * each level, meeting at a @ref data::barrier before the next.
+ *
+ * Each level is expanded in whichever direction is cheaper:
+ *  - top down while the frontier is small. The frontier is shared out in
+ *    chunks, and each thread claims the neighbours of its cells with an
+ *    atomic or on the visited bits, so each cell is reached exactly once,
+ *    and puts the cells it claims in a queue of its own for the next
+ *    level.
+ *  - bottom up once the frontier is a big part of what is left - on a
+ *    braided maze most of the maze can be in the frontier at once. The
+ *    frontier is then a bitmap, and the words of the visited bitmap are
+ *    shared out instead. Each cell not yet reached looks for a neighbour
+ *    in the frontier, stopping at the first, so a thread only ever writes
+ *    its own words and no atomics are needed.
+ *
+ * The search only reads the maze, through the same accessors as the
+ * other solvers. A maze whose passages are looked up rather than stored
+ * in place - one that is sparse, masked or procedural - isn't safe to
+ * read from several threads at once and is searched on one. Such a maze
+ * may also be far too big for state for every cell, so its search keeps
+ * the distances of the cells it reaches in a @ref data::sparse_array and
+ * always goes top down, as a bottom up level looks at every cell.
+ **/
+class parallel_bfs_solver {
+  /// the maze to search
+  const data::maze& _maze;
+  /// the number of threads to search on
+  unsigned _threads;
+  /// a bit for each cell handle that is set once the cell is reached.
+  /// The bits of handles past the end are set from the start.
+  data::arena_vector<std::uint64_t> _visited;
+  /// the cells of the current level and the next as bitmaps, while the
+  /// search goes bottom up
+  data::arena_vector<std::uint64_t> _front, _next;
+  /// the distance of each cell from the start, if it has been reached
+  data::arena_vector<std::uint32_t> _levels;
+  /// one more than the distance of each cell reached, or 0, in a search
+  /// over a sparse maze - one 64x64 tile to a chunk in the tiled layouts
+  data::sparse_array<std::uint32_t, 12> _sparse_levels;
+  /// whether the search keeps its state in @ref _sparse_levels
+  bool _sparse;
+  /// the cells of the current level and the next as a queue for each
+  /// thread, while the search goes top down
+  std::vector<std::vector<data::cell_id> > _queues[2];
+  /// which of @ref _queues holds the current level
+  int _in;
+  /// where the queue of each thread starts in the current level, as if
+  /// the queues were one after the other, with the size of the level last
+  std::vector<std::size_t> _starts;
+  /// the number of cells each thread added to the next level bottom up
+  std::vector<std::size_t> _found;
+  /// the next task of the current level to hand out
+  std::atomic<std::size_t> _next_task;
+  /// the number of tasks in the current level
+  std::size_t _tasks;
+  /// the number of cells in the current level
+  std::size_t _frontier;
+  /// the number of cells reached so far
+  std::size_t _reached;
+  /// the distance of the current level from the start
+  std::uint32_t _level;
+  /// whether the current level is expanded bottom up
+  bool _bottom_up;
+  /// whether the search has finished
+  bool _done;
+  /// the cell the search stops at, or constants::ERROR to go on until
+  /// every cell that can be is reached
+  data::cell_id _goal;
+
+  /// the number of cells of a top down level in each task
+  static const std::size_t TASK_CELLS = 1024;
+  /// the number of words of a bottom up level in each task
+  static const std::size_t TASK_WORDS = 64;
+  /// the search goes bottom up once more than 1 in ALPHA of the cells
+  /// left are in the frontier...
+  static const std::size_t ALPHA = 14;
+  /// ...and back to top down once fewer than 1 in BETA of all the cells
+  /// are
+  static const std::size_t BETA = 24;
+
+  /**
+   * @return whether a cell has been reached
+   **/
+  bool visited(data::cell_id id) const {
+    if (_sparse) return _sparse_levels.get(std::size_t(id)) != 0;
+    return _visited[std::size_t(id) >> 6] >> (id & 63) & 1;
+  }
+
+  /**
+   * marks a cell as reached at a distance from the start if no other
+   * thread has yet
+   * @return whether this thread reached it
+   **/
+  bool claim(data::cell_id id, std::uint32_t level) {
+    if (_sparse) {
+      // a sparse maze is only ever searched on one thread
+      if (_sparse_levels.get(std::size_t(id))) return false;
+      _sparse_levels.touch(std::size_t(id)) = level + 1;
+      return true;
+    }
+    std::uint64_t& word = _visited[std::size_t(id) >> 6];
+    const std::uint64_t bit = std::uint64_t(1) << (id & 63);
+    // most cells that are already reached are found without the atomic
+    if (__atomic_load_n(&word, __ATOMIC_RELAXED) & bit) return false;
+    if (__atomic_fetch_or(&word, bit, __ATOMIC_RELAXED) & bit) return false;
+    _levels[id] = level;
+    return true;
+  }
+
+  /**
+   * expands the cells of one task of a top down level
+   **/
+  void top_down(std::size_t task, unsigned worker);
+
+  /**
+   * looks for the cells of one task of a bottom up level
+   **/
+  void bottom_up(std::size_t task, unsigned worker);
+
+  /**
+   * shares the current level out into tasks
+   **/
+  void plan_level(void);
+
+  /**
+   * ends the current level and sets up the next, choosing which way to
+   * expand it. Only one thread calls it, while the others wait.
+   **/
+  void next_level(void);
+
+ public:
+  /**
+   * @param m the maze to search
+   * @param scratch where the state of the search is allocated from
+   * @param threads the number of threads to search on, or 0 for one per
+   * core
+   **/
+  parallel_bfs_solver(const data::maze& m, data::arena& scratch,
+                      unsigned threads);
+
+  /**
+   * @return the number of threads the solver searches on, which is 1
+   * whatever was asked for if the maze can't be shared between threads
+   **/
+  unsigned threads(void) const { return _threads; }
+
+  /**
+   * works out the distance from start to every cell it can reach, or
+   * only to the cells no further away than goal if one is given
+   * @return the number of cells reached
+   **/
+  std::size_t distances(data::cell_id start,
+                        data::cell_id goal = constants::ERROR);
+
+  /**
+   * @return whether the last search reached a cell
+   **/
+  bool reached(data::cell_id id) const { return visited(id); }
+
+  /**
+   * @return the number of steps from the start of the last search to a
+   * cell it reached
+   **/
+  std::uint32_t distance(data::cell_id id) const {
+    return _sparse ? _sparse_levels.get(std::size_t(id)) - 1 : _levels[id];
+  }
+
+  /**
+   * finds a shortest path from start to goal
+   * @param path set to the cells of the path from start to goal inclusive
+   * @return false if the goal can't be reached from the start, in which
+   * case the path is left empty
+   **/
+  bool solve(data::cell_id start, data::cell_id goal,
+             std::vector<data::cell_id>& path);
+
+  /**
+   * @return the number of cells the last search reached
+   **/
+  std::size_t explored(void) const { return _reached; }
+};
+}  // namespace solvers
+}  // namespace mazer2018
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../data/arena.h"
+#include "../data/maze.h"
+#include "../data/sparse_array.h"
+
+#pragma once
+namespace mazer2018 {
+/**
+ * the namespace under which all solvers live
+ **/
+namespace solvers {
+/**
+ * the per cell state of a search held in flat arrays: a bit per cell for
+ * whether it has been reached and two bits per cell for the direction
+ * back to the cell it was reached from - three bits a cell in all, packed
+ * 64 and 32 cells to a word. A search over a hundred million cells needs
+ * under 40MB of marks, and marks that sit next to each other in the maze
+ * mostly sit in the same cache line.
+ *
+ * A search over a sparse or procedural maze keeps its marks in a
+ * @ref data::sparse_array instead, a byte a cell in chunks that are only
+ * allocated when a cell in them is reached, so its memory follows the
+ * cells searched rather than the size of the maze.
+ **/
+class search_marks {
+  /// whether each cell has been reached, a bit per handle
+  data::arena_vector<std::uint64_t> _visited;
+  /// the direction back to the parent of each cell reached, two bits per
+  /// handle
+  data::arena_vector<std::uint64_t> _parents;
+  /// the marks of a search over a sparse maze - @ref REACHED with the
+  /// direction back to the parent below it - one 64x64 tile to a chunk in
+  /// the tiled layouts
+  data::sparse_array<std::uint8_t, 12> _sparse_marks;
+  /// whether the marks are held in @ref _sparse_marks
+  bool _sparse;
+
+  /// the bit of a sparse mark that is set once the cell is reached
+  static const std::uint8_t REACHED = 4;
+
+ public:
+  /**
+   * constructs marks that are allocated from an arena
+   **/
+  explicit search_marks(data::arena& a)
+      : _visited(data::arena_allocator<std::uint64_t>(a)),
+        _parents(data::arena_allocator<std::uint64_t>(a)),
+        _sparse(false) {}
+
+  /**
+   * starts a new search over a maze with the number of cell handles
+   * specified. Afterwards no cell has been reached.
+   **/
+  void reset(std::size_t cells) {
+    if (_sparse) {
+      _sparse = false;
+      _sparse_marks.clear();
+    }
+    _visited.assign((cells + 63) / 64, 0);
+    // parents are only read for cells that have been reached so they
+    // needn't be cleared
+    _parents.resize((cells + 31) / 32);
+  }
+
+  /**
+   * starts a new search over a sparse maze. Afterwards no cell has been
+   * reached.
+   **/
+  void reset_sparse(void) {
+    // the dense marks are no longer needed so give their memory back
+    data::arena_vector<std::uint64_t>(_visited.get_allocator()).swap(_visited);
+    data::arena_vector<std::uint64_t>(_parents.get_allocator()).swap(_parents);
+    _sparse = true;
+    _sparse_marks.clear();
+  }
+
+  /**
+   * starts a new search over the maze specified
+   **/
+  void reset(const data::maze& m) {
+    // a procedural maze may be far too big for marks for every cell
+    if (m.sparse() || m.procedural()) {
+      reset_sparse();
+    } else {
+      reset(std::size_t(m.capacity()));
+    }
+  }
+
+  /**
+   * @return whether a cell has been reached
+   **/
+  bool visited(data::cell_id id) const {
+    if (_sparse) return _sparse_marks.get(std::size_t(id)) & REACHED;
+    return (_visited[std::size_t(id) >> 6] >> (id & 63)) & 1;
+  }
+
+  /**
+   * marks a cell as reached
+   * @param parent the direction from the cell back to the cell it was
+   * reached from
+   **/
+  void visit(data::cell_id id, data::direction parent) {
+    if (_sparse) {
+      _sparse_marks.touch(std::size_t(id)) =
+          std::uint8_t(REACHED | int(parent));
+      return;
+    }
+    _visited[std::size_t(id) >> 6] |= std::uint64_t(1) << (id & 63);
+    std::uint64_t& word = _parents[std::size_t(id) >> 5];
+    const int shift = int(id & 31) * 2;
+    word = (word & ~(std::uint64_t(3) << shift)) |
+           (std::uint64_t(parent) << shift);
+  }
+
+  /**
+   * @return the direction from a cell that has been reached back to the
+   * cell it was reached from
+   **/
+  data::direction parent(data::cell_id id) const {
+    if (_sparse) {
+      return data::direction(_sparse_marks.get(std::size_t(id)) & 3);
+    }
+    return data::direction(
+        (_parents[std::size_t(id) >> 5] >> (int(id & 31) * 2)) & 3);
+  }
+
+  /**
+   * follows the parents back from a cell to the start of the search
+   * @param path set to the cells from the start to the cell given
+   **/
+  void trace(const data::maze& m, data::cell_id start, data::cell_id cell,
+             std::vector<data::cell_id>& path) const {
+    path.clear();
+    path.push_back(cell);
+    while (cell != start) {
+      cell = m.neighbour(cell, parent(cell));
+      path.push_back(cell);
+    }
+    std::reverse(path.begin(), path.end());
+  }
+};
+}  // namespace solvers
+}  // namespace mazer2018